@@ -1,17 +1,20 @@
+%code requires {
+#include "parsecontext.h"
+}
+
 %{
 #include <stdio.h>
 #include <string.h>
 #include "parsetree.h"
-#include "main.h"
-
-extern int yylex( void );
-extern void yyerror(const char * s);
-extern FILE *yyin;
-char *transferStr(const char *origin);
+#include "lexer.h"
 
-parseToken *programToken;
+extern void yyerror(void *scanner, parseContext *context, const char *s);
 %}
 
+%define api.pure full
+%lex-param {void *scanner}
+%parse-param {void *scanner} {parseContext *context}
+
 %%
 
 %token <value> NUMBER;
@@ -20,7 +23,8 @@ parseToken *programToken;
 %token _ELSE _WHILE _DO _REPEAT _UNTIL _FOR _TO _BY _RETURN;
 
 %type <parsed> varSections procedures body varSection varDeclarations procedureVarSection;
-%type <parsed> varDeclaration procedure procedureHeader paramList parameter instructionSequence instruction;
+%type <parsed> varDeclaration procedure procedureHeader paramList parameter instructionSequence;
+%type <parsed> instructions instruction;
 %type <parsed> varCall elseSection whileLoop repeatUntilLoop forLoop;
 %type <parsed> iterativeAdvancement conditionalInstruction value procedureCall assignment;
 %type <parsed> paramListCall returnStatement condition expression binaryExpression;
@@ -28,7 +32,7 @@ parseToken *programToken;
 %type <name> head;
 
 %union {
-    char *name;
+    int name;
     int value;
     struct parseToken *parsed;
 };
@@ -41,65 +45,68 @@ parseToken *programToken;
 epsilon         :                                       {;}
                 ;
 
-program         : head varSections procedures body      {programToken = createProgram($1, $2, $3, $4);}
+program         : head varSections procedures body      {context->programToken = createProgram(context->tokens, $1, $2, $3, $4);}
                 ;
 
                 head: _PROGRAM IDENTIFIER ';'           {$$ = $2;}
                 ;
 
 body            : _BEGIN instructionSequence _END
-                    IDENTIFIER '.'                      {$$ = createBody($2, $4);}
+                    IDENTIFIER '.'                      {$$ = createBody(context->tokens, $2, $4);}
                 ;
 
-varSections     : varSections varSection                {$$ = createVarSections($1, $2);}
-                | varSection                            {$$ = createVarSections(NULL, $1);}
-                | epsilon                               {$$ = createVarSections(NULL, NULL);}
+varSections     : varSections varSection                {$$ = createVarSections(context->tokens, $1, $2);}
+                | varSection                            {$$ = createVarSections(context->tokens, NULL, $1);}
+                | epsilon                               {$$ = createVarSections(context->tokens, NULL, NULL);}
                 ;
 
-varSection      : _VAR varDeclarations ';'              {$$ = createVarSection($2);}
+varSection      : _VAR varDeclarations ';'              {$$ = createVarSection(context->tokens, $2);}
                 ;
 
 procedureVarSection
-                : varSection                            {$$ = createVarSections(NULL, $1);}
-                | epsilon                               {$$ = createVarSections(NULL, NULL);}
+                : varSection                            {$$ = createVarSections(context->tokens, NULL, $1);}
+                | epsilon                               {$$ = createVarSections(context->tokens, NULL, NULL);}
                 ;
 
-varDeclarations : varDeclarations ',' varDeclaration    {$$ = createVarDeclarations($1, $3);}
-                | varDeclaration                        {$$ = createVarDeclarations(NULL, $1);}
+varDeclarations : varDeclarations ',' varDeclaration    {$$ = createVarDeclarations(context->tokens, $1, $3);}
+                | varDeclaration                        {$$ = createVarDeclarations(context->tokens, NULL, $1);}
                 ;
 
-varDeclaration  : IDENTIFIER '[' NUMBER ']'             {$$ = createVarDeclaration($1, &$3);}
-                | IDENTIFIER                            {$$ = createVarDeclaration($1, NULL);}
+varDeclaration  : IDENTIFIER '[' NUMBER ']'             {$$ = createVarDeclaration(context->tokens, $1, &$3);}
+                | IDENTIFIER                            {$$ = createVarDeclaration(context->tokens, $1, NULL);}
                 ;
 
-procedures      : procedures procedure                  {$$ = createProcedures($1, $2);}
-                | procedure                             {$$ = createProcedures(NULL, $1);}
-                | epsilon                               {$$ = createProcedures(NULL, NULL);}
+procedures      : procedures procedure                  {$$ = createProcedures(context->tokens, $1, $2);}
+                | procedure                             {$$ = createProcedures(context->tokens, NULL, $1);}
+                | epsilon                               {$$ = createProcedures(context->tokens, NULL, NULL);}
                 ;
 
 procedure       : procedureHeader IDENTIFIER '(' paramList ')' ';'
                     procedureVarSection _BEGIN instructionSequence _END
-                    IDENTIFIER ';'                      {$$ = createProcedure($1, $2, $4,
+                    IDENTIFIER ';'                      {$$ = createProcedure(context->tokens, $1, $2, $4,
                         $7, $9, $11);}
                 ;
 
-procedureHeader : _PROCEDURE                            {$$ = createProcedureHeader();}
-                | _FUNCTION                             {$$ = createFunctionHeader();}
+procedureHeader : _PROCEDURE                            {$$ = createProcedureHeader(context->tokens);}
+                | _FUNCTION                             {$$ = createFunctionHeader(context->tokens);}
                 ;
 
-paramList       : paramList ',' parameter               {$$ = createParamList($1, $3);}
-                | parameter                             {$$ = createParamList(NULL, $1);}
-                | epsilon                               {$$ = createParamList(NULL, NULL);}
+paramList       : paramList ',' parameter               {$$ = createParamList(context->tokens, $1, $3);}
+                | parameter                             {$$ = createParamList(context->tokens, NULL, $1);}
+                | epsilon                               {$$ = createParamList(context->tokens, NULL, NULL);}
                 ;
 
-parameter       : _VAR varDeclaration                   {$$ = createReferenceParameter($2);}
-                | varDeclaration                        {$$ = createCopyParameter($1);}
+parameter       : _VAR varDeclaration                   {$$ = createReferenceParameter(context->tokens, $2);}
+                | varDeclaration                        {$$ = createCopyParameter(context->tokens, $1);}
                 ;
 
 instructionSequence
-                : instruction ';' instructionSequence   {$$ = createInstructionSequence($1, $3);}
-                | instruction ';'                       {$$ = createInstructionSequence($1, NULL);}
-                | instruction                           {$$ = createInstructionSequence($1, NULL);}
+                : instructions ';'                      {$$ = $1;}
+                | instructions                          {$$ = $1;}
+                ;
+
+instructions    : instructions ';' instruction          {$$ = createInstructionSequence(context->tokens, $1, $3);}
+                | instruction                           {$$ = createInstructionSequence(context->tokens, NULL, $1);}
                 ;
 
 instruction     : assignment                            {$$ = $1;}
@@ -111,56 +118,56 @@ instruction     : assignment                            {$$ = $1;}
                 | returnStatement                       {$$ = $1;}
                 ;
 
-assignment      : varCall ':' '=' expression            {$$ = createAssignment($1, $4);}
+assignment      : varCall ':' '=' expression            {$$ = createAssignment(context->tokens, $1, $4);}
                 ;
 
-varCall         : IDENTIFIER '[' expression ']'         {$$ = createArrayCall($1, $3);}
-                | IDENTIFIER                            {$$ = createVarCall($1);}
+varCall         : IDENTIFIER '[' expression ']'         {$$ = createArrayCall(context->tokens, $1, $3);}
+                | IDENTIFIER                            {$$ = createVarCall(context->tokens, $1);}
                 ;
 
 conditionalInstruction
                 : _IF condition _THEN instructionSequence
-                    elseSection _END                    {$$ = createConditional($2, $4, $5);}
+                    elseSection _END                    {$$ = createConditional(context->tokens, $2, $4, $5);}
                 ;
 
-elseSection     : _ELSE instructionSequence             {$$ = createElseSection($2);}
-                | epsilon                               {$$ = createElseSection(NULL);}
+elseSection     : _ELSE instructionSequence             {$$ = createElseSection(context->tokens, $2);}
+                | epsilon                               {$$ = createElseSection(context->tokens, NULL);}
                 ;
 
 whileLoop       : _WHILE condition
-                    _DO instructionSequence _END        {$$ = createWhileLoop($2, $4);}
+                    _DO instructionSequence _END        {$$ = createWhileLoop(context->tokens, $2, $4);}
                 ;
 
 repeatUntilLoop : _REPEAT instructionSequence
-                    _UNTIL condition                    {$$ = createRepeatLoop($2, $4);}
+                    _UNTIL condition                    {$$ = createRepeatLoop(context->tokens, $2, $4);}
                 ;
 
 forLoop         : _FOR assignment _TO expression
                     iterativeAdvancement
-                    _DO instructionSequence _END        {$$ = createForLoop($2, $4, $5, $7);}
+                    _DO instructionSequence _END        {$$ = createForLoop(context->tokens, $2, $4, $5, $7);}
                 ;
 
 iterativeAdvancement
-                : _BY '+' NUMBER                        {$$ = createPositiveAdvancement($3);}
-                | _BY NUMBER                            {$$ = createPositiveAdvancement($2);}
-                | _BY '-' NUMBER                        {$$ = createNegativeAdvancement($3);}
-                | epsilon                               {$$ = createPositiveAdvancement(1);}
+                : _BY '+' NUMBER                        {$$ = createPositiveAdvancement(context->tokens, $3);}
+                | _BY NUMBER                            {$$ = createPositiveAdvancement(context->tokens, $2);}
+                | _BY '-' NUMBER                        {$$ = createNegativeAdvancement(context->tokens, $3);}
+                | epsilon                               {$$ = createPositiveAdvancement(context->tokens, 1);}
                 ;
 
-procedureCall   : IDENTIFIER '(' paramListCall ')'      {$$ = createProcedureCall($1, $3);}
+procedureCall   : IDENTIFIER '(' paramListCall ')'      {$$ = createProcedureCall(context->tokens, $1, $3);}
                 ;
 
-paramListCall   : paramListCall ',' expression          {$$ = createParamListCall($1, $3);}
-                | expression                            {$$ = createParamListCall(NULL, $1);}
-                | epsilon                               {$$ = createParamListCall(NULL, NULL);}
+paramListCall   : paramListCall ',' expression          {$$ = createParamListCall(context->tokens, $1, $3);}
+                | expression                            {$$ = createParamListCall(context->tokens, NULL, $1);}
+                | epsilon                               {$$ = createParamListCall(context->tokens, NULL, NULL);}
                 ;
 
-returnStatement : _RETURN expression                    {$$ = createReturnStatement($2);}
-                | _RETURN                               {$$ = createReturnStatement(NULL);}
+returnStatement : _RETURN expression                    {$$ = createReturnStatement(context->tokens, $2);}
+                | _RETURN                               {$$ = createReturnStatement(context->tokens, NULL);}
                 ;
 
 condition       : expression conditionalOperator
-                    expression                          {$$ = createCondition($1, $2, $3);}
+                    expression                          {$$ = createCondition(context->tokens, $1, $2, $3);}
                 ;
 
 conditionalOperator
@@ -173,51 +180,60 @@ conditionalOperator
                 ;
 
 expression
-                : '(' expression ')'                    {$$ = createBrackets($2);}
-                | '-' expression                        {$$ = createNegation($2);}
-                | value                                 {$$ = createUnaryExpression($1);}
+                : '(' expression ')'                    {$$ = createBrackets(context->tokens, $2);}
+                | '-' expression                        {$$ = createNegation(context->tokens, $2);}
+                | value                                 {$$ = createUnaryExpression(context->tokens, $1);}
                 | binaryExpression                      {$$ = $1;}
                 ;
 
-binaryExpression: expression '+' expression             {$$ = createBinaryExpression($1, 0, $3);}
-                | expression '-' expression             {$$ = createBinaryExpression($1, 1, $3);}
-                | expression '*' expression             {$$ = createBinaryExpression($1, 2, $3);}
-                | expression '/' expression             {$$ = createBinaryExpression($1, 3, $3);}
-                | expression '%' expression             {$$ = createBinaryExpression($1, 4, $3);}
+binaryExpression: expression '+' expression             {$$ = createBinaryExpression(context->tokens, $1, 0, $3);}
+                | expression '-' expression             {$$ = createBinaryExpression(context->tokens, $1, 1, $3);}
+                | expression '*' expression             {$$ = createBinaryExpression(context->tokens, $1, 2, $3);}
+                | expression '/' expression             {$$ = createBinaryExpression(context->tokens, $1, 3, $3);}
+                | expression '%' expression             {$$ = createBinaryExpression(context->tokens, $1, 4, $3);}
                 ;
 
-value           : varCall                               {$$ = createValueByCall($1);}
-                | NUMBER                                {$$ = createValue($1);}
-                | procedureCall                         {$$ = createValueByCall($1);}
+value           : varCall                               {$$ = createValueByCall(context->tokens, $1);}
+                | NUMBER                                {$$ = createValue(context->tokens, $1);}
+                | procedureCall                         {$$ = createValueByCall(context->tokens, $1);}
                 ;
 
 %%
 
-int main(int argc, char **argv) {
-	FILE *in = fopen("", "r");
-	if (argc > 1) {
-		in = fopen(argv[1], "r");
-		if (!in) {
-			fprintf(stderr, "File couldn't be read, using stdin.\n");
-		} else {
-			yyin = in;
-		}
-	}
-    int success = yyparse();
-	if (in) {
-		fclose(in);
-	}
-    return handle(programToken, success);
+int parseSource(sourceBuffer *source, parseContext *context) {
+    scanner sc;
+    initScanner(&sc, source, context);
+    
+    // With timing the tokens are scanned first, so the parser only replays them
+    if(context->timer != NULL) {
+        enterPhase(context->timer, phaseLexing);
+        int failed = scanAllTokens(&sc);
+        leavePhase(context->timer);
+        
+        if(failed) {
+            fprintf(context->errors, "Couldn't assign memory to scan the input!\n");
+            freeScanner(&sc);
+            return 1;
+        }
+    }
+    
+    enterPhase(context->timer, phaseParsing);
+    context->source = source;
+    int result = yyparse(&sc, context);
+    context->source = NULL;
+    leavePhase(context->timer);
+    
+    freeScanner(&sc);
+    return result;
 }
 
-void yyerror (const char *s)
+void yyerror(void *argument, parseContext *context, const char *s)
 {
-    extern int yylineno;
-    fprintf(stderr, "An error occurred (%s) in line %i!\n", s, yylineno);
-}
-    
-char *transferStr(const char *origin) {
-    char *target = malloc(strlen(origin) + 1);
-    strcpy(target, origin);
-    return target;
+    scanner *sc = (scanner *) argument;
+    const char *lineStart = sc->token;
+    while(lineStart > context->source->text && lineStart[-1] != '\n') {
+        --lineStart;
+    }
+    fprintf(context->errors, "An error occurred (%s) in line %i, column %i!\n", s,
+            sc->line, (int) (sc->token - lineStart) + 1);
 }
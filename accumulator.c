@@ -0,0 +1,117 @@
+#include "accumulator.h"
+
+#define MAX_KNOWN 4
+
+typedef struct accumulatorContent accumulatorContent;
+
+// The operands whose value the accumulator holds right now: constants, addresses and words that
+// are addressed directly. No store can make a word differ from the accumulator, as it always
+// writes the accumulator, so only a new value in it, a call or a label forgets them.
+struct accumulatorContent {
+    operand known[MAX_KNOWN];
+    int nKnown;
+};
+
+static int isTracked(operand *arg) {
+    return arg->addressing == addressImmediate || arg->addressing == addressAbsolute;
+}
+
+static int sameOperand(operand *a, operand *b) {
+    return a->addressing == b->addressing && a->base == b->base && a->value == b->value;
+}
+
+static int holds(accumulatorContent *content, operand *arg) {
+    for(int i = 0; i < content->nKnown; ++i) {
+        if(sameOperand(&content->known[i], arg)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// The oldest operand is forgotten if there are too many
+static void addKnown(accumulatorContent *content, operand *arg) {
+    if(!isTracked(arg) || holds(content, arg)) {
+        return;
+    }
+    if(content->nKnown == MAX_KNOWN) {
+        for(int i = 1; i < MAX_KNOWN; ++i) {
+            content->known[i - 1] = content->known[i];
+        }
+        --content->nKnown;
+    }
+    content->known[content->nKnown++] = *arg;
+}
+
+// The offsets to SP follow a change of SP, words that were released are forgotten
+static void moveStack(accumulatorContent *content, int change) {
+    int kept = 0;
+    for(int i = 0; i < content->nKnown; ++i) {
+        operand *arg = &content->known[i];
+        if(arg->base == baseStack) {
+            arg->value += change;
+            if(arg->addressing == addressAbsolute && arg->value < 0) {
+                continue;
+            }
+        }
+        content->known[kept++] = *arg;
+    }
+    content->nKnown = kept;
+}
+
+// Follows the content of the accumulator through the straight code between labels and calls.
+// Loads of a value it already holds and stores of it to a word that already holds it are removed.
+// Returns 1 if something was removed.
+int removeRedundantLoads(instructionList *list) {
+    accumulatorContent content;
+    content.nKnown = 0;
+    int length = 0;
+    
+    for(int i = 0; i < list->length; ++i) {
+        machineInstruction *next = &list->code[i];
+        
+        switch(next->opcode) {
+            case opLoad:
+                if(holds(&content, &next->arg)) {
+                    continue;
+                }
+                content.nKnown = 0;
+                addKnown(&content, &next->arg);
+                break;
+            case opStore:
+                if(next->arg.addressing == addressAbsolute && holds(&content, &next->arg)) {
+                    continue;
+                }
+                addKnown(&content, &next->arg);
+                break;
+            case opPush: {
+                operand top = stackOperand(addressAbsolute, 0);
+                moveStack(&content, 1);
+                addKnown(&content, &top);
+                break;
+            }
+            case opRsv:
+                moveStack(&content, next->arg.value);
+                break;
+            case opRel:
+                moveStack(&content, -next->arg.value);
+                break;
+            case opCmp:
+            case opWord:
+                break;
+            default:
+                // The code after a conditional jump is only reached from it, until the next label.
+                // Anything else changes the accumulator or continues at a label.
+                if(!isJump(next->opcode) || next->opcode == opJmp) {
+                    content.nKnown = 0;
+                }
+                break;
+        }
+        
+        list->code[length++] = *next;
+    }
+    
+    int changed = length != list->length;
+    list->length = length;
+    return changed;
+}
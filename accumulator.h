@@ -0,0 +1,8 @@
+#ifndef ACCUMULATOR_H
+#define ACCUMULATOR_H
+
+#include "instructions.h"
+
+int removeRedundantLoads(instructionList *list);
+
+#endif //ACCUMULATOR_H
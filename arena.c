@@ -0,0 +1,117 @@
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+
+#define DEFAULT_BLOCK_SIZE (64 * 1024)
+#define ARENA_ALIGNMENT alignof(max_align_t)
+
+size_t alignSize(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+}
+
+char *blockData(arenaBlock *block) {
+    return (char *) block + alignSize(sizeof(arenaBlock));
+}
+
+arenaBlock *createBlock(size_t size) {
+    arenaBlock *result = (arenaBlock *) malloc(alignSize(sizeof(arenaBlock)) + size);
+    if(result == NULL) {
+        return NULL;
+    }
+    result->next = NULL;
+    result->size = size;
+    result->used = 0;
+    return result;
+}
+
+arena *createArena(void) {
+    arena *result = (arena *) malloc(sizeof(arena));
+    result->blockSize = DEFAULT_BLOCK_SIZE;
+    result->blocks = NULL;
+    return result;
+}
+
+// Releases every allocation of the arena at once
+void freeArena(arena *ar) {
+    if(ar == NULL) {
+        return;
+    }
+    
+    arenaBlock *block = ar->blocks;
+    while(block != NULL) {
+        arenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    
+    free(ar);
+}
+
+// Releases every allocation, but keeps one regular block for the next use of the arena
+void resetArena(arena *ar) {
+    arenaBlock *kept = NULL;
+    arenaBlock *block = ar->blocks;
+    
+    while(block != NULL) {
+        arenaBlock *next = block->next;
+        if(kept == NULL && block->size == ar->blockSize) {
+            kept = block;
+        } else {
+            free(block);
+        }
+        block = next;
+    }
+    
+    if(kept != NULL) {
+        kept->next = NULL;
+        kept->used = 0;
+    }
+    ar->blocks = kept;
+}
+
+// Returns zeroed memory, which lives as long as the arena
+void *arenaAlloc(arena *ar, size_t size) {
+    size = alignSize(size);
+    
+    arenaBlock *block = ar->blocks;
+    
+    if(block == NULL || block->size - block->used < size) {
+        if(size > ar->blockSize / 4) {
+            // Big allocations get their own block behind the current one, so the rest
+            // of the current block can still be used
+            arenaBlock *ownBlock = createBlock(size);
+            if(ownBlock == NULL) {
+                return NULL;
+            }
+            ownBlock->used = size;
+            if(block != NULL) {
+                ownBlock->next = block->next;
+                block->next = ownBlock;
+            } else {
+                ar->blocks = ownBlock;
+            }
+            memset(blockData(ownBlock), 0, size);
+            return blockData(ownBlock);
+        }
+        
+        block = createBlock(ar->blockSize);
+        if(block == NULL) {
+            return NULL;
+        }
+        block->next = ar->blocks;
+        ar->blocks = block;
+    }
+    
+    void *result = blockData(block) + block->used;
+    block->used += size;
+    memset(result, 0, size);
+    return result;
+}
+
+char *arenaStr(arena *ar, const char *str, size_t length) {
+    char *result = (char *) arenaAlloc(ar, length + 1);
+    memcpy(result, str, length);
+    result[length] = '\0';
+    return result;
+}
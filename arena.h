@@ -0,0 +1,31 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+typedef struct arenaBlock arenaBlock;
+
+struct arenaBlock {
+    arenaBlock *next;
+    size_t size;
+    size_t used;
+};
+
+typedef struct arena arena;
+
+struct arena {
+    arenaBlock *blocks;
+    size_t blockSize;
+};
+
+arena *createArena(void);
+
+void freeArena(arena *ar);
+
+void resetArena(arena *ar);
+
+void *arenaAlloc(arena *ar, size_t size);
+
+char *arenaStr(arena *ar, const char *str, size_t length);
+
+#endif //ARENA_H
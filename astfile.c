@@ -0,0 +1,303 @@
+#include "astfile.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define BYTE_ORDER_MARK 0x01020304
+
+typedef struct astWriter astWriter;
+
+struct astWriter {
+    astNode *nodes;
+    uint32_t nNodes;
+    uint32_t nodesCapacity;
+    int32_t *values;
+    uint32_t valuesCapacity;
+    uint8_t *valueTypes;
+    uint32_t valueTypesCapacity;
+    uint32_t nValues;
+    int32_t *children;
+    uint32_t nChildren;
+    uint32_t childrenCapacity;
+    // The index in the file of every interned name, or -1 if the tree doesn't use it
+    int *nameIndices;
+    int *names;
+    uint32_t nNames;
+};
+
+int reserve(void **array, uint32_t *capacity, uint32_t needed, size_t size) {
+    if(needed <= *capacity) {
+        return 0;
+    }
+    
+    uint32_t newCapacity = *capacity * 2 + 64;
+    if(newCapacity < needed) {
+        newCapacity = needed;
+    }
+    
+    void *tmp = realloc(*array, newCapacity * size);
+    if(tmp == NULL) {
+        return 1;
+    }
+    *array = tmp;
+    *capacity = newCapacity;
+    return 0;
+}
+
+int addName(astWriter *writer, int id) {
+    if(writer->nameIndices[id] < 0) {
+        writer->nameIndices[id] = (int) writer->nNames;
+        writer->names[writer->nNames++] = id;
+    }
+    return writer->nameIndices[id];
+}
+
+// Adds the token and everything below it and returns the index of its node. The children get
+// their slots before they are added, so every node comes before its children.
+int32_t addNode(astWriter *writer, parseToken *token) {
+    if(token == NULL) {
+        return -1;
+    }
+    
+    uint32_t index = writer->nNodes;
+    uint32_t firstValue = writer->nValues;
+    uint32_t firstChild = writer->nChildren;
+    
+    if(reserve((void **) &writer->nodes, &writer->nodesCapacity, index + 1, sizeof(astNode)) != 0
+            || reserve((void **) &writer->children, &writer->childrenCapacity,
+                    firstChild + token->nNodes, sizeof(int32_t)) != 0) {
+        return -2;
+    }
+    
+    if(reserve((void **) &writer->values, &writer->valuesCapacity, firstValue + token->nVal,
+            sizeof(int32_t)) != 0
+            || reserve((void **) &writer->valueTypes, &writer->valueTypesCapacity,
+                    firstValue + token->nVal, sizeof(uint8_t)) != 0) {
+        return -2;
+    }
+    
+    for(int i = 0; i < token->nVal; ++i) {
+        writer->valueTypes[firstValue + i] = (uint8_t) token->valueTypes[i];
+        if(token->valueTypes[i] == string) {
+            writer->values[firstValue + i] = addName(writer, token->values[i].name);
+        } else {
+            writer->values[firstValue + i] = token->values[i].value;
+        }
+    }
+    
+    writer->nodes[index].type = (uint16_t) token->type;
+    writer->nodes[index].nValues = (uint16_t) token->nVal;
+    writer->nodes[index].nChildren = (uint32_t) token->nNodes;
+    writer->nNodes = index + 1;
+    writer->nValues = firstValue + token->nVal;
+    writer->nChildren = firstChild + token->nNodes;
+    
+    for(int i = 0; i < token->nNodes; ++i) {
+        int32_t child = addNode(writer, token->subNodes[i]);
+        if(child < -1) {
+            return child;
+        }
+        writer->children[firstChild + i] = child;
+    }
+    
+    return (int32_t) index;
+}
+
+int writeAst(parseToken *programToken, interner *symbols, FILE *output) {
+    astWriter writer;
+    memset(&writer, 0, sizeof(writer));
+    writer.nameIndices = (int *) malloc((symbols->nNames + 1) * sizeof(int));
+    writer.names = (int *) malloc((symbols->nNames + 1) * sizeof(int));
+    
+    int result = 1;
+    if(writer.nameIndices != NULL && writer.names != NULL) {
+        memset(writer.nameIndices, -1, (symbols->nNames + 1) * sizeof(int));
+        result = addNode(&writer, programToken) < 0;
+    }
+    
+    if(result == 0) {
+        uint32_t *nameOffsets = (uint32_t *) malloc((writer.nNames + 1) * sizeof(uint32_t));
+        uint32_t namesSize = 0;
+        for(uint32_t i = 0; nameOffsets != NULL && i < writer.nNames; ++i) {
+            nameOffsets[i] = namesSize;
+            namesSize += (uint32_t) strlen(symbolName(symbols, writer.names[i]));
+        }
+        
+        if(nameOffsets == NULL) {
+            result = 1;
+        } else {
+            nameOffsets[writer.nNames] = namesSize;
+            
+            astHeader header;
+            memset(&header, 0, sizeof(header));
+            memcpy(header.magic, AST_MAGIC, sizeof(header.magic));
+            header.version = AST_VERSION;
+            header.byteOrder = BYTE_ORDER_MARK;
+            header.nNodes = writer.nNodes;
+            header.nValues = writer.nValues;
+            header.nChildren = writer.nChildren;
+            header.nNames = writer.nNames;
+            header.namesSize = namesSize;
+            
+            fwrite(&header, sizeof(header), 1, output);
+            fwrite(writer.nodes, sizeof(astNode), writer.nNodes, output);
+            fwrite(writer.values, sizeof(int32_t), writer.nValues, output);
+            fwrite(writer.children, sizeof(int32_t), writer.nChildren, output);
+            fwrite(nameOffsets, sizeof(uint32_t), writer.nNames + 1, output);
+            fwrite(writer.valueTypes, sizeof(uint8_t), writer.nValues, output);
+            for(uint32_t i = 0; i < writer.nNames; ++i) {
+                fputs(symbolName(symbols, writer.names[i]), output);
+            }
+            result = ferror(output) != 0;
+            free(nameOffsets);
+        }
+    }
+    
+    free(writer.nodes);
+    free(writer.values);
+    free(writer.valueTypes);
+    free(writer.children);
+    free(writer.nameIndices);
+    free(writer.names);
+    return result;
+}
+
+int isAstFile(const char *data, size_t length) {
+    return length >= sizeof(astHeader) && memcmp(data, AST_MAGIC, 8) == 0;
+}
+
+// Checks every index before the tree is built, so a damaged file can't produce a broken tree
+int validateAst(const astHeader *header, const astNode *nodes, const int32_t *values,
+        const uint8_t *valueTypes, const int32_t *children, const uint32_t *nameOffsets) {
+    uint64_t nValues = 0;
+    uint64_t nChildren = 0;
+    
+    if(header->nNodes == 0) {
+        return 1;
+    }
+    
+    for(uint32_t i = 0; i < header->nNodes; ++i) {
+        const astNode *node = &nodes[i];
+        if(node->type > value || nValues + node->nValues > header->nValues
+                || nChildren + node->nChildren > header->nChildren) {
+            return 1;
+        }
+        
+        for(uint64_t j = nChildren; j < nChildren + node->nChildren; ++j) {
+            if(children[j] != -1 && (children[j] <= (int64_t) i
+                    || (uint32_t) children[j] >= header->nNodes)) {
+                return 1;
+            }
+        }
+        nValues += node->nValues;
+        nChildren += node->nChildren;
+    }
+    
+    if(nValues != header->nValues || nChildren != header->nChildren) {
+        return 1;
+    }
+    
+    for(uint32_t i = 0; i < header->nValues; ++i) {
+        if(valueTypes[i] == string) {
+            if(values[i] < 0 || (uint32_t) values[i] >= header->nNames) {
+                return 1;
+            }
+        } else if(valueTypes[i] != number) {
+            return 1;
+        }
+    }
+    
+    for(uint32_t i = 0; i < header->nNames; ++i) {
+        if(nameOffsets[i] > nameOffsets[i + 1]) {
+            return 1;
+        }
+    }
+    return nameOffsets[header->nNames] > header->namesSize;
+}
+
+// Builds the tree in the arena of the context. The names are interned once each, everything
+// else is one pass over the arrays of the file.
+int loadAst(const char *data, size_t length, parseContext *context) {
+    astHeader header;
+    if(!isAstFile(data, length)) {
+        fprintf(context->errors, "The input isn't a parse tree!\n");
+        return 1;
+    }
+    memcpy(&header, data, sizeof(header));
+    
+    if(header.version != AST_VERSION || header.byteOrder != BYTE_ORDER_MARK) {
+        fprintf(context->errors, "The parse tree was written by another version of the compiler!\n");
+        return 1;
+    }
+    
+    uint64_t size = sizeof(astHeader) + (uint64_t) header.nNodes * sizeof(astNode)
+            + (uint64_t) header.nValues * (sizeof(int32_t) + sizeof(uint8_t))
+            + (uint64_t) header.nChildren * sizeof(int32_t)
+            + ((uint64_t) header.nNames + 1) * sizeof(uint32_t) + header.namesSize;
+    if(size != length) {
+        fprintf(context->errors, "The parse tree is damaged!\n");
+        return 1;
+    }
+    
+    const astNode *nodes = (const astNode *) (data + sizeof(astHeader));
+    const int32_t *values = (const int32_t *) (nodes + header.nNodes);
+    const int32_t *children = (const int32_t *) (values + header.nValues);
+    const uint32_t *nameOffsets = (const uint32_t *) (children + header.nChildren);
+    const uint8_t *valueTypes = (const uint8_t *) (nameOffsets + header.nNames + 1);
+    const char *names = (const char *) (valueTypes + header.nValues);
+    
+    if(validateAst(&header, nodes, values, valueTypes, children, nameOffsets) != 0) {
+        fprintf(context->errors, "The parse tree is damaged!\n");
+        return 1;
+    }
+    
+    int *ids = (int *) malloc((header.nNames + 1) * sizeof(int));
+    parseToken *tokens = (parseToken *) arenaAlloc(context->tokens, header.nNodes * sizeof(parseToken));
+    YYSTYPE *tokenValues = (YYSTYPE *) arenaAlloc(context->tokens, header.nValues * sizeof(YYSTYPE));
+    valueType *tokenValueTypes = (valueType *) arenaAlloc(context->tokens,
+            header.nValues * sizeof(valueType));
+    parseToken **subNodes = (parseToken **) arenaAlloc(context->tokens,
+            header.nChildren * sizeof(parseToken *));
+    
+    if(ids == NULL || tokens == NULL || tokenValues == NULL || tokenValueTypes == NULL
+            || subNodes == NULL) {
+        fprintf(context->errors, "Couldn't assign memory to load the parse tree!\n");
+        free(ids);
+        return 1;
+    }
+    
+    for(uint32_t i = 0; i < header.nNames; ++i) {
+        ids[i] = internName(context->symbols, names + nameOffsets[i],
+                nameOffsets[i + 1] - nameOffsets[i]);
+    }
+    
+    for(uint32_t i = 0; i < header.nValues; ++i) {
+        tokenValueTypes[i] = (valueType) valueTypes[i];
+        if(valueTypes[i] == string) {
+            tokenValues[i].name = ids[values[i]];
+        } else {
+            tokenValues[i].value = values[i];
+        }
+    }
+    
+    for(uint32_t i = 0; i < header.nChildren; ++i) {
+        subNodes[i] = children[i] < 0 ? NULL : &tokens[children[i]];
+    }
+    
+    uint32_t firstValue = 0;
+    uint32_t firstChild = 0;
+    for(uint32_t i = 0; i < header.nNodes; ++i) {
+        tokens[i].type = (parseType) nodes[i].type;
+        tokens[i].values = tokenValues + firstValue;
+        tokens[i].valueTypes = tokenValueTypes + firstValue;
+        tokens[i].nVal = (int) nodes[i].nValues;
+        tokens[i].subNodes = subNodes + firstChild;
+        tokens[i].nNodes = (int) nodes[i].nChildren;
+        tokens[i].nodesCapacity = (int) nodes[i].nChildren;
+        firstValue += nodes[i].nValues;
+        firstChild += nodes[i].nChildren;
+    }
+    
+    free(ids);
+    context->programToken = &tokens[0];
+    return 0;
+}
@@ -0,0 +1,47 @@
+#ifndef ASTFILE_H
+#define ASTFILE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "parsetree.h"
+#include "parsecontext.h"
+
+#define AST_MAGIC "MISAST\n"
+#define AST_VERSION 1
+
+// The parse tree in flat arrays, so it can be loaded from a mapped file in one linear pass.
+// Numbers are in the byte order of the machine that wrote the file. The header is followed by
+// the nodes, the values, the children, the offsets of the names (one more than there are
+// names), the value types as single bytes and the characters of the names. The values and
+// children of the nodes follow each other in the order of the nodes. The root is the first
+// node, children always come after their parents and -1 stands for a missing child.
+typedef struct astHeader astHeader;
+
+struct astHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t nNodes;
+    uint32_t nValues;
+    uint32_t nChildren;
+    uint32_t nNames;
+    uint32_t namesSize;
+    uint32_t reserved;
+};
+
+typedef struct astNode astNode;
+
+struct astNode {
+    uint16_t type;
+    uint16_t nValues;
+    uint32_t nChildren;
+};
+
+int isAstFile(const char *data, size_t length);
+
+int writeAst(parseToken *programToken, interner *symbols, FILE *output);
+
+int loadAst(const char *data, size_t length, parseContext *context);
+
+#endif //ASTFILE_H
@@ -0,0 +1,254 @@
+//
+//  benchmark.c
+//  CPU-Simulation-Lang
+//
+//  Generates programs of growing size and measures how fast the compiler translates them.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "programgenerator.h"
+
+#define MAX_COMPILER_ARGS 32
+
+typedef struct measurement measurement;
+
+struct measurement {
+    long lines;
+    off_t sourceSize;
+    off_t outputSize;
+    double wall;
+    double cpu;
+    long peakRss;
+};
+
+double secondsBetween(struct timespec *start, struct timespec *end) {
+    return (double) (end->tv_sec - start->tv_sec) + (double) (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+double timevalSeconds(struct timeval *time) {
+    return (double) time->tv_sec + (double) time->tv_usec / 1e6;
+}
+
+off_t fileSize(const char *path) {
+    struct stat info;
+    if(stat(path, &info) != 0) {
+        return -1;
+    }
+    return info.st_size;
+}
+
+int writeProgram(const generatorOptions *options, const char *path, long *lines) {
+    FILE *source = fopen(path, "w");
+    if(source == NULL) {
+        fprintf(stderr, "The program \"%s\" couldn't be created!\n", path);
+        return 1;
+    }
+    
+    *lines = generateProgram(options, source);
+    if(fclose(source) != 0 || *lines < 0) {
+        fprintf(stderr, "The program \"%s\" couldn't be written!\n", path);
+        return 1;
+    }
+    return 0;
+}
+
+// Runs the compiler as a child, so its peak RSS is measured on its own
+int runCompiler(char **compilerArgs, measurement *result) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    // Nothing buffered may be written twice by the child
+    fflush(stdout);
+    pid_t child = fork();
+    if(child < 0) {
+        fprintf(stderr, "The compiler couldn't be started!\n");
+        return 1;
+    }
+    if(child == 0) {
+        // Only the diagnostics are shown, the assembly is written with -o
+        freopen("/dev/null", "w", stdout);
+        execv(compilerArgs[0], compilerArgs);
+        fprintf(stderr, "The compiler \"%s\" couldn't be executed!\n", compilerArgs[0]);
+        _exit(127);
+    }
+    
+    int status;
+    struct rusage usage;
+    if(wait4(child, &status, 0, &usage) < 0) {
+        fprintf(stderr, "The compiler couldn't be awaited!\n");
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "The compiler failed!\n");
+        return 1;
+    }
+    
+    result->wall = secondsBetween(&start, &end);
+    result->cpu = timevalSeconds(&usage.ru_utime) + timevalSeconds(&usage.ru_stime);
+    result->peakRss = usage.ru_maxrss;
+    return 0;
+}
+
+void printMeasurement(measurement *result, int json, int first) {
+    double linesPerSecond = result->wall > 0 ? (double) result->lines / result->wall : 0;
+    
+    if(json) {
+        printf("%s\n  {\"lines\": %ld, \"source_bytes\": %lld, \"wall_seconds\": %.6f, "
+                "\"cpu_seconds\": %.6f, \"lines_per_second\": %.0f, \"peak_rss_kb\": %ld, "
+                "\"output_bytes\": %lld}", first ? "" : ",", result->lines,
+                (long long) result->sourceSize, result->wall, result->cpu, linesPerSecond,
+                result->peakRss, (long long) result->outputSize);
+    } else {
+        printf("%10ld %14lld %10.3f %10.3f %14.0f %12ld %14lld\n", result->lines,
+                (long long) result->sourceSize, result->wall, result->cpu, linesPerSecond,
+                result->peakRss, (long long) result->outputSize);
+    }
+    fflush(stdout);
+}
+
+void printUsage(void) {
+    fprintf(stderr, "Usage: ./benchmark [-g lines] [-x max-lines] [-P compiler] [-d directory] [--json]\n"
+            "                   [-S seed] [-p procedures] [-n statements] [-e expression-depth]\n"
+            "                   [-N nesting-depth] [-A array-size] [-k call-percent]\n"
+            "                   [-- compiler options ...]\n");
+}
+
+int main(int argc, char **argv) {
+    generatorOptions options;
+    initGeneratorOptions(&options);
+    
+    long generateLines = 0;
+    long maxLines = 10000000;
+    char *compilerPath = "./compiler";
+    char *directory = NULL;
+    int json = 0;
+    char *extraArgs[MAX_COMPILER_ARGS];
+    int nExtraArgs = 0;
+    
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            generateLines = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-x") == 0 && i + 1 < argc) {
+            maxLines = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-P") == 0 && i + 1 < argc) {
+            compilerPath = argv[++i];
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            directory = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0) {
+            json = 1;
+        } else if (strcmp(argv[i], "-S") == 0 && i + 1 < argc) {
+            options.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            options.procedures = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            options.statements = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            options.expressionDepth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-N") == 0 && i + 1 < argc) {
+            options.nestingDepth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-A") == 0 && i + 1 < argc) {
+            options.arraySize = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            options.callDensity = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--") == 0) {
+            while(++i < argc && nExtraArgs < MAX_COMPILER_ARGS) {
+                extraArgs[nExtraArgs++] = argv[i];
+            }
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    
+    if(options.statements < 1 || options.expressionDepth < 0 || options.nestingDepth < 0
+            || options.arraySize < 1 || options.callDensity < 0 || options.callDensity > 100) {
+        fprintf(stderr, "The options of the generated programs are out of range!\n");
+        return 1;
+    }
+    
+    // With -g only one program is written to stdout
+    if(generateLines > 0) {
+        options.lines = generateLines;
+        return generateProgram(&options, stdout) < 0;
+    }
+    
+    char template[] = "/tmp/benchmark.XXXXXX";
+    int removeDirectory = directory == NULL;
+    if(directory == NULL) {
+        directory = mkdtemp(template);
+        if(directory == NULL) {
+            fprintf(stderr, "The directory for the programs couldn't be created!\n");
+            return 1;
+        }
+    }
+    
+    size_t pathLength = strlen(directory) + 32;
+    char *sourcePath = malloc(pathLength);
+    char *outputPath = malloc(pathLength);
+    char *compilerArgs[MAX_COMPILER_ARGS + 5];
+    
+    if(json) {
+        printf("[");
+    } else {
+        printf("%10s %14s %10s %10s %14s %12s %14s\n", "lines", "source bytes", "wall s",
+                "cpu s", "lines/s", "peak RSS KB", "output bytes");
+    }
+    
+    int returnVal = 0;
+    for(long lines = 1000; lines <= maxLines; lines *= 10) {
+        snprintf(sourcePath, pathLength, "%s/bench-%ld.mis", directory, lines);
+        snprintf(outputPath, pathLength, "%s/bench-%ld.asm", directory, lines);
+        
+        measurement result;
+        options.lines = lines;
+        if(writeProgram(&options, sourcePath, &result.lines) != 0) {
+            returnVal = 1;
+            break;
+        }
+        
+        int nArgs = 0;
+        compilerArgs[nArgs++] = compilerPath;
+        compilerArgs[nArgs++] = sourcePath;
+        compilerArgs[nArgs++] = "-o";
+        compilerArgs[nArgs++] = outputPath;
+        for(int i = 0; i < nExtraArgs; ++i) {
+            compilerArgs[nArgs++] = extraArgs[i];
+        }
+        compilerArgs[nArgs] = NULL;
+        
+        int failed = runCompiler(compilerArgs, &result);
+        result.sourceSize = fileSize(sourcePath);
+        result.outputSize = fileSize(outputPath);
+        
+        if(removeDirectory) {
+            unlink(sourcePath);
+            unlink(outputPath);
+        }
+        
+        if(failed) {
+            returnVal = 1;
+            break;
+        }
+        printMeasurement(&result, json, lines == 1000);
+    }
+    
+    if(json) {
+        printf("\n]\n");
+    }
+    
+    if(removeDirectory) {
+        rmdir(directory);
+    }
+    free(sourcePath);
+    free(outputPath);
+    return returnVal;
+}
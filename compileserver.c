@@ -0,0 +1,355 @@
+#include "compileserver.h"
+#include "parsecontext.h"
+#include "interpreter.h"
+#include "procedurecache.h"
+#include "main.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define MAX_REQUEST_SIZE (64 * 1024 * 1024)
+// The assembly of a big source can be much bigger than the source, so answers are only limited by
+// their length field
+#define MAX_ANSWER_SIZE UINT32_MAX
+
+typedef struct compileServer compileServer;
+
+// The contexts of finished connections are kept, so the next connections start with warm
+// arenas and interned names. The code of unchanged procedures is reused across all connections.
+struct compileServer {
+    threadPool *pool;
+    procedureCache *cache;
+    int optimize;
+    pthread_mutex_t lock;
+    parseContext **idleContexts;
+    int nIdleContexts;
+    int idleCapacity;
+};
+
+typedef struct serverConnection serverConnection;
+
+struct serverConnection {
+    compileServer *server;
+    int fd;
+};
+
+int readAll(int fd, void *buffer, size_t length) {
+    char *position = (char *) buffer;
+    while(length > 0) {
+        ssize_t count = read(fd, position, length);
+        if(count <= 0) {
+            return 1;
+        }
+        position += count;
+        length -= count;
+    }
+    return 0;
+}
+
+int writeAll(int fd, const void *buffer, size_t length) {
+    const char *position = (const char *) buffer;
+    while(length > 0) {
+        ssize_t count = send(fd, position, length, MSG_NOSIGNAL);
+        if(count <= 0) {
+            return 1;
+        }
+        position += count;
+        length -= count;
+    }
+    return 0;
+}
+
+int readNumber(int fd, uint32_t *number) {
+    uint32_t value;
+    if(readAll(fd, &value, sizeof(value)) != 0) {
+        return 1;
+    }
+    *number = ntohl(value);
+    return 0;
+}
+
+int writeNumber(int fd, uint32_t number) {
+    uint32_t value = htonl(number);
+    return writeAll(fd, &value, sizeof(value));
+}
+
+int writeText(int fd, const char *text, size_t length) {
+    if(length > MAX_ANSWER_SIZE || writeNumber(fd, (uint32_t) length) != 0) {
+        return 1;
+    }
+    return writeAll(fd, text, length);
+}
+
+// Reads a length of at most maxLength and that many bytes, followed by SOURCE_PADDING null
+// bytes, so the text can be scanned in place
+char *readText(int fd, uint32_t *length, uint32_t maxLength) {
+    if(readNumber(fd, length) != 0 || *length > maxLength) {
+        return NULL;
+    }
+    
+    char *text = (char *) malloc((size_t) *length + SOURCE_PADDING);
+    if(text == NULL) {
+        return NULL;
+    }
+    
+    if(readAll(fd, text, *length) != 0) {
+        free(text);
+        return NULL;
+    }
+    memset(text + *length, 0, SOURCE_PADDING);
+    return text;
+}
+
+parseContext *takeContext(compileServer *server) {
+    parseContext *context = NULL;
+    
+    pthread_mutex_lock(&server->lock);
+    if(server->nIdleContexts > 0) {
+        context = server->idleContexts[--(server->nIdleContexts)];
+    }
+    pthread_mutex_unlock(&server->lock);
+    
+    if(context == NULL) {
+        context = createParseContext(NULL);
+        context->optimize = server->optimize;
+    }
+    return context;
+}
+
+void returnContext(compileServer *server, parseContext *context) {
+    pthread_mutex_lock(&server->lock);
+    if(server->nIdleContexts == server->idleCapacity) {
+        int capacity = server->idleCapacity * 2 + 1;
+        parseContext **tmp = (parseContext **) realloc(server->idleContexts,
+                capacity * sizeof(parseContext *));
+        if(tmp != NULL) {
+            server->idleContexts = tmp;
+            server->idleCapacity = capacity;
+        }
+    }
+    
+    if(server->nIdleContexts < server->idleCapacity) {
+        server->idleContexts[(server->nIdleContexts)++] = context;
+        context = NULL;
+    }
+    pthread_mutex_unlock(&server->lock);
+    
+    freeParseContext(context);
+}
+
+// Compiles the source like a single input file and answers with the assembly and diagnostics
+int answerRequest(int fd, parseContext *context, sourceBuffer *source, threadPool *pool,
+        procedureCache *cache) {
+    char *assembly = NULL;
+    size_t assemblyLength = 0;
+    char *diagnostics = NULL;
+    size_t diagnosticsLength = 0;
+    
+    FILE *errors = open_memstream(&diagnostics, &diagnosticsLength);
+    FILE *output = open_memstream(&assembly, &assemblyLength);
+    int success = 1;
+    
+    if(errors != NULL && output != NULL) {
+        resetParseContext(context, errors);
+        success = parseSource(source, context);
+        
+        if(success == 0) {
+            createAssembly(context->programToken, context->tokens, context->symbols, pool,
+                    cache, NULL, context->optimize, 0, output, errors, &success);
+        }
+        
+        fclose(output);
+        output = NULL;
+        if(success == 0 && assemblyLength > MAX_ANSWER_SIZE) {
+            fprintf(errors, "The assembly is too big to be sent!\n");
+            success = 1;
+        }
+        
+        if(success == 0) {
+            fprintf(errors, "Successfully parsed!\n");
+        }
+        context->errors = NULL;
+    }
+    
+    if(output != NULL) {
+        fclose(output);
+    }
+    if(errors != NULL) {
+        fclose(errors);
+    }
+    
+    // Like with an output file, the assembly of a failed compilation isn't handed out
+    if(success != 0) {
+        assemblyLength = 0;
+    }
+    
+    int result = writeNumber(fd, (uint32_t) success) != 0
+            || writeText(fd, assembly, assemblyLength) != 0
+            || writeText(fd, diagnostics, diagnosticsLength) != 0;
+    
+    free(assembly);
+    free(diagnostics);
+    return result;
+}
+
+// A connection can send any number of requests, until it is closed
+void *serveConnection(void *argument) {
+    serverConnection *connection = (serverConnection *) argument;
+    compileServer *server = connection->server;
+    parseContext *context = takeContext(server);
+    
+    while(1) {
+        uint32_t length;
+        char *text = readText(connection->fd, &length, MAX_REQUEST_SIZE);
+        if(text == NULL) {
+            break;
+        }
+        
+        sourceBuffer source = {text, length, 0};
+        int failed = answerRequest(connection->fd, context, &source, server->pool,
+                server->cache);
+        freeSource(&source);
+        if(failed) {
+            break;
+        }
+    }
+    
+    returnContext(server, context);
+    close(connection->fd);
+    free(connection);
+    return NULL;
+}
+
+int openServerSocket(char *socketPath) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    
+    if(strlen(socketPath) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "The socket path \"%s\" is too long!\n", socketPath);
+        return -1;
+    }
+    strcpy(address.sun_path, socketPath);
+    
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0) {
+        fprintf(stderr, "The socket couldn't be created!\n");
+        return -1;
+    }
+    
+    unlink(socketPath);
+    
+    if(bind(fd, (struct sockaddr *) &address, sizeof(address)) != 0 || listen(fd, 64) != 0) {
+        fprintf(stderr, "The server couldn't listen on \"%s\"!\n", socketPath);
+        close(fd);
+        return -1;
+    }
+    
+    return fd;
+}
+
+// Serves every connection on its own thread, until the process is stopped
+int runServer(char *socketPath, threadPool *pool, int optimize) {
+    int fd = openServerSocket(socketPath);
+    if(fd < 0) {
+        return 1;
+    }
+    
+    compileServer server;
+    server.pool = pool;
+    server.cache = createProcedureCache();
+    server.optimize = optimize;
+    pthread_mutex_init(&server.lock, NULL);
+    server.idleContexts = NULL;
+    server.nIdleContexts = 0;
+    server.idleCapacity = 0;
+    
+    while(1) {
+        int connectionFd = accept(fd, NULL, NULL);
+        if(connectionFd < 0) {
+            continue;
+        }
+        
+        serverConnection *connection = (serverConnection *) malloc(sizeof(serverConnection));
+        connection->server = &server;
+        connection->fd = connectionFd;
+        
+        pthread_t thread;
+        if(pthread_create(&thread, NULL, serveConnection, connection) != 0) {
+            close(connectionFd);
+            free(connection);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+}
+
+// Sends the input to a running server and writes the answer like a local compilation would
+int runClient(char *socketPath, sourceBuffer *source, char *outputPath) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    
+    if(strlen(socketPath) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "The socket path \"%s\" is too long!\n", socketPath);
+        return 1;
+    }
+    strcpy(address.sun_path, socketPath);
+    
+    if(source->length > MAX_REQUEST_SIZE) {
+        fprintf(stderr, "The input is too big for the server!\n");
+        return 1;
+    }
+    
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0 || connect(fd, (struct sockaddr *) &address, sizeof(address)) != 0) {
+        fprintf(stderr, "The server at \"%s\" couldn't be reached!\n", socketPath);
+        if(fd >= 0) {
+            close(fd);
+        }
+        return 1;
+    }
+    
+    uint32_t success = 1;
+    uint32_t assemblyLength = 0;
+    uint32_t diagnosticsLength = 0;
+    char *assembly = NULL;
+    char *diagnostics = NULL;
+    
+    int failed = writeText(fd, source->text, source->length) != 0
+            || readNumber(fd, &success) != 0
+            || (assembly = readText(fd, &assemblyLength, MAX_ANSWER_SIZE)) == NULL
+            || (diagnostics = readText(fd, &diagnosticsLength, MAX_ANSWER_SIZE)) == NULL;
+    close(fd);
+    
+    if(failed) {
+        fprintf(stderr, "The server at \"%s\" didn't answer!\n", socketPath);
+        free(assembly);
+        free(diagnostics);
+        return 1;
+    }
+    
+    fwrite(diagnostics, 1, diagnosticsLength, stderr);
+    
+    if(success == 0) {
+        char *tmpPath;
+        char *targetPath;
+        FILE *output = openOutput(outputPath, &tmpPath, &targetPath, stderr);
+        
+        if(output == NULL) {
+            success = 1;
+        } else {
+            fwrite(assembly, 1, assemblyLength, output);
+            success = closeOutput(output, tmpPath, targetPath, 0, stderr);
+        }
+    }
+    
+    free(assembly);
+    free(diagnostics);
+    return (int) success;
+}
@@ -0,0 +1,16 @@
+#ifndef COMPILESERVER_H
+#define COMPILESERVER_H
+
+#include <stdio.h>
+#include "threadpool.h"
+#include "sourcebuffer.h"
+
+// A request is the length of the source as a 4 byte big endian number, followed by the source.
+// The answer is the exit code, the length and text of the assembly and the length and text
+// of the diagnostics, all lengths and the exit code again as 4 byte big endian numbers.
+
+int runServer(char *socketPath, threadPool *pool, int optimize);
+
+int runClient(char *socketPath, sourceBuffer *source, char *outputPath);
+
+#endif //COMPILESERVER_H
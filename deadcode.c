@@ -0,0 +1,169 @@
+#include "deadcode.h"
+#include "simplifier.h"
+#include <string.h>
+
+// Whether a condition with two constants holds, decided like the machine does it, by the flags of
+// the difference of the two words. Returns -1 if the condition isn't constant.
+int getConstantCondition(parseToken *tok) {
+    parseToken *left = tok->subNodes[0];
+    parseToken *right = tok->subNodes[1];
+    if(left->exprType != literalValue || right->exprType != literalValue) {
+        return -1;
+    }
+    
+    int difference = toWord(toWord(getRecursiveExpressionValue(left))
+            - toWord(getRecursiveExpressionValue(right)));
+    int zero = difference == 0;
+    int negative = difference < 0;
+    
+    switch(tok->values[0].value) {
+        case 1:
+            return !zero;
+        case 2:
+            return negative;
+        case 3:
+            return !negative && !zero;
+        case 4:
+            return negative || zero;
+        case 5:
+            return !negative;
+        default:
+            return zero;
+    }
+}
+
+static parseToken *getElseInstructions(parseToken *tok) {
+    parseToken *elseSection = tok->subNodes[2];
+    return elseSection->nNodes > 0 ? elseSection->subNodes[0] : NULL;
+}
+
+static int alwaysReturns(parseToken *tok);
+
+// Only the last instruction has to be looked at, as nothing is kept after one that returns
+static int sequenceReturns(parseToken *tok) {
+    return tok->nNodes > 0 && alwaysReturns(tok->subNodes[tok->nNodes - 1]);
+}
+
+// Unlike testForNeededReturn, an IF without an ELSE never counts, as its condition can be false
+static int alwaysReturns(parseToken *tok) {
+    switch(tok->type) {
+        case returnStatement:
+            return 1;
+        case repeatLoop:
+            return sequenceReturns(tok->subNodes[0]);
+        case conditionalInstruction: {
+            parseToken *elseInstructions = getElseInstructions(tok);
+            return elseInstructions != NULL && sequenceReturns(tok->subNodes[1])
+                    && sequenceReturns(elseInstructions);
+        }
+        default:
+            return 0;
+    }
+}
+
+// A copy of the statement whose sub nodes can be replaced without changing the statement itself
+static parseToken *copyStatement(parseToken *tok, arena *tokens) {
+    parseToken *result = (parseToken *) arenaAlloc(tokens, sizeof(parseToken));
+    *result = *tok;
+    result->subNodes = (parseToken **) arenaAlloc(tokens, tok->nNodes * sizeof(parseToken *));
+    memcpy(result->subNodes, tok->subNodes, tok->nNodes * sizeof(parseToken *));
+    result->nodesCapacity = tok->nNodes;
+    return result;
+}
+
+static parseToken *replaceInstructions(parseToken *tok, int index, arena *tokens,
+        deadCodeReport *report) {
+    parseToken *result = copyStatement(tok, tokens);
+    result->subNodes[index] = removeDeadCode(tok->subNodes[index], tokens, report);
+    return result;
+}
+
+// Returns the statement with the dead code of the instructions it contains removed
+static parseToken *removeNestedDeadCode(parseToken *tok, arena *tokens, deadCodeReport *report) {
+    switch(tok->type) {
+        case conditionalInstruction: {
+            parseToken *result = replaceInstructions(tok, 1, tokens, report);
+            if(getElseInstructions(tok) != NULL) {
+                result->subNodes[2] = replaceInstructions(tok->subNodes[2], 0, tokens, report);
+            }
+            return result;
+        }
+        case whileLoop:
+            return replaceInstructions(tok, 1, tokens, report);
+        case repeatLoop:
+            return replaceInstructions(tok, 0, tokens, report);
+        case forLoop:
+            return replaceInstructions(tok, 3, tokens, report);
+        default:
+            return tok;
+    }
+}
+
+static parseToken *appendInstructions(parseToken *kept, parseToken *instructions, arena *tokens) {
+    for(int i = 0; i < instructions->nNodes; ++i) {
+        kept = createInstructionSequence(tokens, kept, instructions->subNodes[i]);
+    }
+    return kept;
+}
+
+// Appends what is left of the instruction to the kept ones: the instruction itself, the
+// instructions of the branch a constant condition always takes, or nothing
+static parseToken *appendLiveInstruction(parseToken *kept, parseToken *tok, arena *tokens,
+        deadCodeReport *report) {
+    tok = removeNestedDeadCode(tok, tokens, report);
+    
+    switch(tok->type) {
+        case conditionalInstruction: {
+            parseToken *elseInstructions = getElseInstructions(tok);
+            int constant = getConstantCondition(tok->subNodes[0]);
+            if(constant >= 0) {
+                ++report->constantConditions;
+                parseToken *taken = constant ? tok->subNodes[1] : elseInstructions;
+                return taken != NULL ? appendInstructions(kept, taken, tokens) : kept;
+            }
+            if(tok->subNodes[1]->nNodes == 0
+                    && (elseInstructions == NULL || elseInstructions->nNodes == 0)
+                    && !hasCall(tok->subNodes[0])) {
+                ++report->emptyStatements;
+                return kept;
+            }
+            break;
+        }
+        case whileLoop:
+            if(getConstantCondition(tok->subNodes[0]) == 0) {
+                ++report->constantConditions;
+                return kept;
+            }
+            break;
+        case repeatLoop:
+            if(getConstantCondition(tok->subNodes[1]) == 1) {
+                ++report->constantConditions;
+                return appendInstructions(kept, tok->subNodes[0], tokens);
+            }
+            break;
+        default:
+            break;
+    }
+    
+    return createInstructionSequence(tokens, kept, tok);
+}
+
+// Removes the instructions of the sequence that can never run or never change anything: the ones
+// after a RETURN, the branches and loops a constant condition never takes and IFs without
+// instructions. Loops whose condition isn't constant are kept even without instructions, they
+// could run forever. Has to run after simplifyTree, which makes the constant conditions literal.
+// Returns the sequence that replaces the token. The tree itself isn't changed, the statements that
+// change are copied to tokens, so the result mustn't outlive them.
+parseToken *removeDeadCode(parseToken *tok, arena *tokens, deadCodeReport *report) {
+    parseToken *kept = createInstructionSequence(tokens, NULL, NULL);
+    
+    for(int i = 0; i < tok->nNodes; ++i) {
+        kept = appendLiveInstruction(kept, tok->subNodes[i], tokens, report);
+        if(sequenceReturns(kept)) {
+            report->afterReturn += tok->nNodes - i - 1;
+            break;
+        }
+    }
+    
+    return kept;
+}
@@ -0,0 +1,20 @@
+#ifndef DEADCODE_H
+#define DEADCODE_H
+
+#include "parsetree.h"
+#include "arena.h"
+
+typedef struct deadCodeReport deadCodeReport;
+
+// How many statements were removed, by the reason they could be
+struct deadCodeReport {
+    int afterReturn;
+    int constantConditions;
+    int emptyStatements;
+};
+
+int getConstantCondition(parseToken *tok);
+
+parseToken *removeDeadCode(parseToken *tok, arena *tokens, deadCodeReport *report);
+
+#endif //DEADCODE_H
@@ -0,0 +1,258 @@
+#include "diskcache.h"
+#include "sha256.h"
+#include "tempfile.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+#define USAGE_FILE "usage"
+// Temporary files that weren't changed for this long were left by a writer that was stopped
+#define STALE_TEMP_SECONDS 3600
+
+typedef struct cacheEntry cacheEntry;
+
+struct cacheEntry {
+    char *path;
+    long long size;
+    struct timespec lastUse;
+};
+
+diskCache *openDiskCache(const char *directory, long long maxSize, FILE *errors) {
+    struct stat info;
+
+    if(mkdir(directory, 0777) != 0 && errno != EEXIST) {
+        fprintf(errors, "The cache directory \"%s\" couldn't be created!\n", directory);
+        return NULL;
+    }
+
+    if(stat(directory, &info) != 0 || !S_ISDIR(info.st_mode)) {
+        fprintf(errors, "The cache \"%s\" isn't a directory!\n", directory);
+        return NULL;
+    }
+
+    diskCache *cache = (diskCache *) malloc(sizeof(diskCache));
+    cache->directory = strdup(directory);
+    cache->maxSize = maxSize;
+    return cache;
+}
+
+void freeDiskCache(diskCache *cache) {
+    if(cache == NULL) {
+        return;
+    }
+    free(cache->directory);
+    free(cache);
+}
+
+// The key covers the compiler and the options, so a cached assembly is only used where
+// compiling again would produce the same
+void getCacheKey(const char *source, size_t length, const char *options, char *key) {
+    sha256Context context;
+    sha256Init(&context);
+    sha256Update(&context, COMPILER_VERSION, strlen(COMPILER_VERSION) + 1);
+    sha256Update(&context, options, strlen(options) + 1);
+    sha256Update(&context, source, length);
+    sha256Hex(&context, key);
+}
+
+char *getCachePath(diskCache *cache, const char *name) {
+    size_t length = strlen(cache->directory) + strlen(name) + 2;
+    char *path = (char *) malloc(length);
+    snprintf(path, length, "%s/%s", cache->directory, name);
+    return path;
+}
+
+char *getEntryPath(diskCache *cache, const char *key) {
+    size_t length = strlen(cache->directory) + 68;
+    char *path = (char *) malloc(length);
+    snprintf(path, length, "%s/%.2s/%s", cache->directory, key, key + 2);
+    return path;
+}
+
+// A hit marks the entry as used, the least recently used entries are evicted first
+FILE *openCachedAssembly(diskCache *cache, const char *key) {
+    char *path = getEntryPath(cache, key);
+    FILE *entry = fopen(path, "r");
+    free(path);
+
+    if(entry != NULL) {
+        futimens(fileno(entry), NULL);
+    }
+    return entry;
+}
+
+int compareLastUse(const void *first, const void *second) {
+    const cacheEntry *a = (const cacheEntry *) first;
+    const cacheEntry *b = (const cacheEntry *) second;
+
+    if(a->lastUse.tv_sec != b->lastUse.tv_sec) {
+        return a->lastUse.tv_sec < b->lastUse.tv_sec ? -1 : 1;
+    }
+    if(a->lastUse.tv_nsec != b->lastUse.tv_nsec) {
+        return a->lastUse.tv_nsec < b->lastUse.tv_nsec ? -1 : 1;
+    }
+    return 0;
+}
+
+// Has to be called with the usage file locked. Removes the least recently used entries until a
+// quarter of the space is free again and returns the size of the rest. Temporary files that
+// writers left behind are removed as well.
+long long evictEntries(diskCache *cache) {
+    cacheEntry *entries = NULL;
+    int nEntries = 0;
+    int capacity = 0;
+    long long total = 0;
+    time_t staleBefore = time(NULL) - STALE_TEMP_SECONDS;
+
+    DIR *directory = opendir(cache->directory);
+    if(directory == NULL) {
+        return 0;
+    }
+
+    struct dirent *subdirectory;
+    while((subdirectory = readdir(directory)) != NULL) {
+        if(strlen(subdirectory->d_name) != 2 || subdirectory->d_name[0] == '.') {
+            continue;
+        }
+
+        char *subdirectoryPath = getCachePath(cache, subdirectory->d_name);
+        DIR *files = opendir(subdirectoryPath);
+
+        struct dirent *file;
+        while(files != NULL && (file = readdir(files)) != NULL) {
+            struct stat info;
+            size_t length = strlen(subdirectoryPath) + strlen(file->d_name) + 2;
+            char *path = (char *) malloc(length);
+            snprintf(path, length, "%s/%s", subdirectoryPath, file->d_name);
+
+            if(file->d_name[0] == '.' || stat(path, &info) != 0 || !S_ISREG(info.st_mode)) {
+                free(path);
+                continue;
+            }
+            
+            // Entry names are plain hex, a dot marks the temporary file of an entry another
+            // process is still writing, unless it was stopped long ago
+            if(strchr(file->d_name, '.') != NULL) {
+                if(info.st_mtim.tv_sec < staleBefore) {
+                    unlink(path);
+                }
+                free(path);
+                continue;
+            }
+
+            if(nEntries == capacity) {
+                capacity = capacity * 2 + 64;
+                cacheEntry *tmp = (cacheEntry *) realloc(entries, capacity * sizeof(cacheEntry));
+                if(tmp == NULL) {
+                    free(path);
+                    break;
+                }
+                entries = tmp;
+            }
+
+            entries[nEntries].path = path;
+            entries[nEntries].size = info.st_size;
+            entries[nEntries].lastUse = info.st_mtim;
+            ++nEntries;
+            total += info.st_size;
+        }
+
+        if(files != NULL) {
+            closedir(files);
+        }
+        free(subdirectoryPath);
+    }
+    closedir(directory);
+
+    qsort(entries, nEntries, sizeof(cacheEntry), compareLastUse);
+
+    for(int i = 0; i < nEntries; ++i) {
+        if(total > cache->maxSize / 4 * 3 && unlink(entries[i].path) == 0) {
+            total -= entries[i].size;
+        }
+        free(entries[i].path);
+    }
+    free(entries);
+
+    return total;
+}
+
+// The size of all entries is kept in the usage file, so the directory only has to be scanned
+// when the cache is full. Other processes wait on the lock of the file meanwhile.
+void addUsage(diskCache *cache, long long size) {
+    char *path = getCachePath(cache, USAGE_FILE);
+    int fd = open(path, O_RDWR | O_CREAT, 0666);
+    free(path);
+
+    if(fd < 0) {
+        return;
+    }
+
+    if(flock(fd, LOCK_EX) != 0) {
+        close(fd);
+        return;
+    }
+
+    char text[32];
+    ssize_t length = pread(fd, text, sizeof(text) - 1, 0);
+    text[length > 0 ? length : 0] = '\0';
+
+    long long usage = atoll(text) + size;
+    if(usage > cache->maxSize) {
+        usage = evictEntries(cache);
+    }
+
+    length = snprintf(text, sizeof(text), "%lld\n", usage);
+    if(ftruncate(fd, 0) == 0) {
+        pwrite(fd, text, length, 0);
+    }
+
+    flock(fd, LOCK_UN);
+    close(fd);
+}
+
+// The entry only becomes visible once it is complete, a failure just leaves it out of the cache.
+// It is linked instead of renamed, so only the process that actually creates it counts its size
+// if several store the same key.
+void storeCachedAssembly(diskCache *cache, const char *key, const char *assembly, size_t length) {
+    char subdirectory[3] = {key[0], key[1], '\0'};
+    char *subdirectoryPath = getCachePath(cache, subdirectory);
+    mkdir(subdirectoryPath, 0777);
+    free(subdirectoryPath);
+
+    char *path = getEntryPath(cache, key);
+    char *tmpPath;
+    int fd = createTempFile(path, &tmpPath);
+    if(fd < 0) {
+        free(path);
+        return;
+    }
+
+    size_t written = 0;
+    while(written < length) {
+        ssize_t count = write(fd, assembly + written, length - written);
+        if(count <= 0) {
+            break;
+        }
+        written += count;
+    }
+
+    if(close(fd) == 0 && written == length) {
+        if(link(tmpPath, path) == 0) {
+            addUsage(cache, (long long) length);
+        } else if(errno != EEXIST && rename(tmpPath, path) == 0) {
+            // Without hard links the entry is replaced, which can only count it twice
+            addUsage(cache, (long long) length);
+        }
+    }
+    unlink(tmpPath);
+
+    free(path);
+    free(tmpPath);
+}
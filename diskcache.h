@@ -0,0 +1,33 @@
+#ifndef DISKCACHE_H
+#define DISKCACHE_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+// Part of every key, has to change whenever the same source can compile to different assembly
+#define COMPILER_VERSION "cpusim-lang 4"
+
+#define DEFAULT_CACHE_SIZE (256LL * 1024 * 1024)
+
+typedef struct diskCache diskCache;
+
+// The assembly of successful compilations, stored as <directory>/<2 hex digits>/<62 hex digits>.
+// Entries are written to a temporary file and linked into place (renamed without hard links), so
+// several processes can share the directory. The least recently used entries are removed when it
+// gets too big, together with the temporary files of writers that were stopped.
+struct diskCache {
+    char *directory;
+    long long maxSize;
+};
+
+diskCache *openDiskCache(const char *directory, long long maxSize, FILE *errors);
+
+void freeDiskCache(diskCache *cache);
+
+void getCacheKey(const char *source, size_t length, const char *options, char *key);
+
+FILE *openCachedAssembly(diskCache *cache, const char *key);
+
+void storeCachedAssembly(diskCache *cache, const char *key, const char *assembly, size_t length);
+
+#endif //DISKCACHE_H
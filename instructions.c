@@ -0,0 +1,173 @@
+#include "instructions.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_CAPACITY 16
+
+// The names of the opcodes with the tabs after them, so the operands line up
+static const char *opcodeNames[N_OPCODES] = {
+    "",
+    "\tLOAD\t",
+    "\tSTORE\t",
+    "\tADD\t\t",
+    "\tSUB\t\t",
+    "\tMUL\t\t",
+    "\tDIV\t\t",
+    "\tMOD\t\t",
+    "\tCMP\t\t",
+    "\tJMP\t\t",
+    "\tJMPZ\t",
+    "\tJMPNZ\t",
+    "\tJMPN\t",
+    "\tJMPNN\t",
+    "\tJMPP\t",
+    "\tJMPNP\t",
+    "\tJMPV\t",
+    "\tJSR\t\t",
+    "\tRTS",
+    "\tPUSH",
+    "\tRSV\t\t",
+    "\tREL\t\t",
+    "\tHOLD",
+    "\tWORD\t"
+};
+
+const operand noOperand = {addressNone, baseNumber, 0};
+
+operand numberOperand(addressing mode, int value) {
+    operand result = {mode, baseNumber, value};
+    return result;
+}
+
+operand symbolOperand(addressing mode, int name) {
+    operand result = {mode, baseSymbol, name};
+    return result;
+}
+
+operand stackOperand(addressing mode, int offset) {
+    operand result = {mode, baseStack, offset};
+    return result;
+}
+
+operand markerOperand(int number) {
+    operand result = {addressAbsolute, baseMarker, number};
+    return result;
+}
+
+int isJump(opcode op) {
+    return op >= opJmp && op <= opJmpv;
+}
+
+instructionList *createInstructions(void) {
+    instructionList *result = (instructionList *) malloc(sizeof(instructionList));
+    result->length = 0;
+    result->capacity = INITIAL_CAPACITY;
+    result->code = (machineInstruction *) malloc(INITIAL_CAPACITY * sizeof(machineInstruction));
+    return result;
+}
+
+void freeInstructions(instructionList *list) {
+    if(list == NULL) {
+        return;
+    }
+    free(list->code);
+    free(list);
+}
+
+int reserveInstructions(instructionList *list, int additional) {
+    int needed = list->length + additional;
+    if(needed <= list->capacity) {
+        return 1;
+    }
+    
+    int newCapacity = list->capacity * 2;
+    while(newCapacity < needed) {
+        newCapacity *= 2;
+    }
+    
+    machineInstruction *tmp = (machineInstruction *) realloc(list->code,
+            newCapacity * sizeof(machineInstruction));
+    if(tmp == NULL) {
+        return 0;
+    }
+    
+    list->code = tmp;
+    list->capacity = newCapacity;
+    return 1;
+}
+
+void appendInstruction(instructionList *list, opcode op, operand arg) {
+    if(!reserveInstructions(list, 1)) {
+        return;
+    }
+    machineInstruction *next = &list->code[list->length++];
+    next->opcode = op;
+    next->arg = arg;
+}
+
+void appendLabel(instructionList *list, operand label) {
+    appendInstruction(list, opLabel, label);
+}
+
+// Appends the instructions of other and frees it
+void appendInstructions(instructionList *list, instructionList *other) {
+    if(reserveInstructions(list, other->length)) {
+        memcpy(list->code + list->length, other->code, other->length * sizeof(machineInstruction));
+        list->length += other->length;
+    }
+    freeInstructions(other);
+}
+
+// Empties the list, but keeps its capacity for reuse
+void clearInstructions(instructionList *list) {
+    list->length = 0;
+}
+
+void printOperand(operand *arg, char **names, int markerOffset, outputBuffer *result) {
+    if(arg->addressing == addressImmediate) {
+        appendChars(result, "$", 1);
+    } else if(arg->addressing == addressIndirect) {
+        appendChars(result, "@", 1);
+    }
+    
+    switch(arg->base) {
+        case baseSymbol:
+            appendStr(result, names[arg->value]);
+            break;
+        case baseStack:
+            appendInt(result, arg->value);
+            appendChars(result, "(SP)", 4);
+            break;
+        case baseMarker:
+            appendChars(result, "m$", 2);
+            appendInt(result, arg->value + markerOffset);
+            break;
+        default:
+            appendInt(result, arg->value);
+    }
+}
+
+// Like printInstructions, but the symbols are indexes into names and the numbered markers are
+// moved by the offset
+void printCode(instructionList *list, char **names, int markerOffset, outputBuffer *result) {
+    for(int i = 0; i < list->length; ++i) {
+        machineInstruction *next = &list->code[i];
+        
+        if(next->opcode == opLabel) {
+            printOperand(&next->arg, names, markerOffset, result);
+            appendChars(result, ":\n", 2);
+            continue;
+        }
+        
+        appendStr(result, opcodeNames[next->opcode]);
+        if(next->arg.addressing != addressNone) {
+            printOperand(&next->arg, names, markerOffset, result);
+        }
+        appendChars(result, "\n", 1);
+    }
+}
+
+// Writes the instructions as assembly text, one per line
+void printInstructions(instructionList *list, interner *symbols, outputBuffer *result) {
+    printCode(list, symbols->names, 0, result);
+}
@@ -0,0 +1,107 @@
+#ifndef INSTRUCTIONS_H
+#define INSTRUCTIONS_H
+
+#include "interner.h"
+#include "outputbuffer.h"
+
+typedef enum opcode opcode;
+
+enum opcode {
+    opLabel,    // No instruction, the operand is the label of the following code
+    opLoad,
+    opStore,
+    opAdd,
+    opSub,
+    opMul,
+    opDiv,
+    opMod,
+    opCmp,
+    opJmp,
+    opJmpz,
+    opJmpnz,
+    opJmpn,
+    opJmpnn,
+    opJmpp,
+    opJmpnp,
+    opJmpv,
+    opJsr,
+    opRts,
+    opPush,
+    opRsv,
+    opRel,
+    opHold,
+    opWord,
+    N_OPCODES
+};
+
+typedef enum addressing addressing;
+
+enum addressing {
+    addressNone,
+    addressImmediate,   // $x, the value or address itself
+    addressAbsolute,    // x, the word at the address
+    addressIndirect     // @x, the word at the address stored at x
+};
+
+typedef enum operandBase operandBase;
+
+enum operandBase {
+    baseNumber,     // A number
+    baseSymbol,     // An interned name: a global, a procedure or a named label
+    baseStack,      // An offset to SP, n(SP)
+    baseMarker      // A numbered label, m$n
+};
+
+typedef struct operand operand;
+
+struct operand {
+    unsigned char addressing;
+    unsigned char base;
+    int value;
+};
+
+typedef struct machineInstruction machineInstruction;
+
+struct machineInstruction {
+    unsigned char opcode;
+    operand arg;
+};
+
+typedef struct instructionList instructionList;
+
+// The code of one section of the program, only printed as assembly after it is complete
+struct instructionList {
+    machineInstruction *code;
+    int length;
+    int capacity;
+};
+
+extern const operand noOperand;
+
+operand numberOperand(addressing mode, int value);
+
+operand symbolOperand(addressing mode, int name);
+
+operand stackOperand(addressing mode, int offset);
+
+operand markerOperand(int number);
+
+int isJump(opcode op);
+
+instructionList *createInstructions(void);
+
+void freeInstructions(instructionList *list);
+
+void appendInstruction(instructionList *list, opcode op, operand arg);
+
+void appendLabel(instructionList *list, operand label);
+
+void appendInstructions(instructionList *list, instructionList *other);
+
+void clearInstructions(instructionList *list);
+
+void printCode(instructionList *list, char **names, int markerOffset, outputBuffer *result);
+
+void printInstructions(instructionList *list, interner *symbols, outputBuffer *result);
+
+#endif //INSTRUCTIONS_H
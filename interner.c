@@ -0,0 +1,120 @@
+#include "interner.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_SLOTS 256
+
+unsigned int hashChars(const char *name, size_t length) {
+    unsigned int hash = 2166136261u;
+    for(size_t i = 0; i < length; ++i) {
+        hash ^= (unsigned char) name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void initSlots(interner *symbols, int nSlots) {
+    symbols->nSlots = nSlots;
+    symbols->slots = (int *) malloc(nSlots * sizeof(int));
+    memset(symbols->slots, -1, nSlots * sizeof(int));
+}
+
+interner *createInterner(void) {
+    interner *result = (interner *) malloc(sizeof(interner));
+    result->nNames = 0;
+    result->namesCapacity = INITIAL_SLOTS / 2;
+    result->names = (char **) malloc(result->namesCapacity * sizeof(char *));
+    result->lengths = (size_t *) malloc(result->namesCapacity * sizeof(size_t));
+    result->hashes = (unsigned int *) malloc(result->namesCapacity * sizeof(unsigned int));
+    result->storage = createArena();
+    initSlots(result, INITIAL_SLOTS);
+    return result;
+}
+
+void freeInterner(interner *symbols) {
+    if(symbols == NULL) {
+        return;
+    }
+    free(symbols->names);
+    free(symbols->lengths);
+    free(symbols->hashes);
+    free(symbols->slots);
+    freeArena(symbols->storage);
+    free(symbols);
+}
+
+int findSlotFor(interner *symbols, const char *name, size_t length, unsigned int hash) {
+    unsigned int mask = symbols->nSlots - 1;
+    unsigned int slot = hash & mask;
+    
+    for(;;) {
+        int id = symbols->slots[slot];
+        if(id < 0) {
+            return slot;
+        }
+        if(symbols->hashes[id] == hash && symbols->lengths[id] == length
+                && memcmp(symbols->names[id], name, length) == 0) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+}
+
+void growSlots(interner *symbols) {
+    free(symbols->slots);
+    initSlots(symbols, symbols->nSlots * 2);
+    
+    unsigned int mask = symbols->nSlots - 1;
+    
+    for(int id = 0; id < symbols->nNames; ++id) {
+        unsigned int slot = symbols->hashes[id] & mask;
+        while(symbols->slots[slot] >= 0) {
+            slot = (slot + 1) & mask;
+        }
+        symbols->slots[slot] = id;
+    }
+}
+
+// Returns the id of the name or -1, if it was never interned
+int findName(interner *symbols, const char *name, size_t length) {
+    unsigned int hash = hashChars(name, length);
+    return symbols->slots[findSlotFor(symbols, name, length, hash)];
+}
+
+// Returns the dense id of the name, every distinct name is only stored once
+int internName(interner *symbols, const char *name, size_t length) {
+    unsigned int hash = hashChars(name, length);
+    int slot = findSlotFor(symbols, name, length, hash);
+    
+    if(symbols->slots[slot] >= 0) {
+        return symbols->slots[slot];
+    }
+    
+    if(symbols->nNames == symbols->namesCapacity) {
+        symbols->namesCapacity *= 2;
+        symbols->names = (char **) realloc(symbols->names, symbols->namesCapacity * sizeof(char *));
+        symbols->lengths = (size_t *) realloc(symbols->lengths, symbols->namesCapacity * sizeof(size_t));
+        symbols->hashes = (unsigned int *) realloc(symbols->hashes,
+                symbols->namesCapacity * sizeof(unsigned int));
+    }
+    
+    int id = symbols->nNames++;
+    symbols->names[id] = arenaStr(symbols->storage, name, length);
+    symbols->lengths[id] = length;
+    symbols->hashes[id] = hash;
+    symbols->slots[slot] = id;
+    
+    if(2 * symbols->nNames > symbols->nSlots) {
+        growSlots(symbols);
+    }
+    
+    return id;
+}
+
+int internStr(interner *symbols, const char *name) {
+    return internName(symbols, name, strlen(name));
+}
+
+const char *symbolName(interner *symbols, int id) {
+    return symbols->names[id];
+}
@@ -0,0 +1,32 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <stddef.h>
+#include "arena.h"
+
+typedef struct interner interner;
+
+struct interner {
+    char **names;
+    size_t *lengths;
+    unsigned int *hashes;
+    int nNames;
+    int namesCapacity;
+    int *slots;
+    int nSlots;
+    arena *storage;
+};
+
+interner *createInterner(void);
+
+void freeInterner(interner *symbols);
+
+int internName(interner *symbols, const char *name, size_t length);
+
+int internStr(interner *symbols, const char *name);
+
+int findName(interner *symbols, const char *name, size_t length);
+
+const char *symbolName(interner *symbols, int id);
+
+#endif //INTERNER_H
@@ -1,30 +1,41 @@
 #include "interpreter.h"
 #include "parsetree.h"
+#include "outputbuffer.h"
+#include "instructions.h"
+#include "symboltable.h"
+#include "interner.h"
+#include "threadpool.h"
+#include "procedurecache.h"
+#include "phasetimer.h"
+#include "peephole.h"
+#include "simplifier.h"
+#include "deadcode.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 
 
-char *catStrs(char target[], const char origin[]);
-char *createStr(void);
-char *transferStr(const char *);
-char *itostr(int);
-
 
 typedef struct varList varList;
 struct varList {
-    char **vars;
+    int *vars;
     int *varIsArray;
     int *varIsReference;
+    int *positions;
     int nVars;
+    int totalSize;
+    symbolTable *index;
 };
 
 varList *getVarList(void) {
     varList *result = (varList *) malloc(sizeof(varList));
     result->nVars = 0;
-    result->vars = (char **) malloc(0);
+    result->totalSize = 0;
+    result->vars = (int *) malloc(0);
     result->varIsArray = (int *) malloc(0);
     result->varIsReference = (int *) malloc(0);
+    result->positions = (int *) malloc(0);
+    result->index = createSymbolTable();
     
     return result;
 }
@@ -35,47 +46,62 @@ varList *cpVarList(varList *origin) {
     int number = origin->nVars;
     
     result->nVars = number;
-    result->vars = (char **) calloc(number, sizeof(char *));
+    result->vars = (int *) calloc(number, sizeof(int));
     result->varIsArray = (int *) calloc(number, sizeof(int));
     result->varIsReference = (int *) calloc(number, sizeof(int));
+    result->positions = (int *) calloc(number, sizeof(int));
+    result->totalSize = origin->totalSize;
     
     for(int i = 0; i < number; ++i) {
-        result->vars[i] = transferStr(origin->vars[i]);
+        result->vars[i] = origin->vars[i];
         result->varIsReference[i] = origin->varIsReference[i];
         result->varIsArray[i] = origin->varIsArray[i];
+        result->positions[i] = origin->positions[i];
     }
     
+    result->index = cpSymbolTable(origin->index);
+    
     return result;
 }
 
 void freeVarList(varList *vl) {
-    for(int i = 0; i < vl->nVars; ++i) {
-        free(vl->vars[i]);
-    }
     free(vl->vars);
     free(vl->varIsArray);
     free(vl->varIsReference);
+    free(vl->positions);
+    freeSymbolTable(vl->index);
     
     free(vl);
 }
 
+// The number of words the variable takes up in the list of variables
+int getVarSize(varList *list, int index) {
+    if(list->varIsArray[index] < 1) {
+        return 1;
+    }
+    return list->varIsArray[index];
+}
+
 typedef struct functionDef functionDef;
 struct functionDef {
-    char *name;
+    int name;
     int isFunction;
     varList *parameters;
+    int nParams;
+    int sizeOnStack;
 };
 
-functionDef *createFunction(char *name, int isFunction) {
+functionDef *createFunction(int name, int isFunction) {
     functionDef *result = (functionDef *) malloc(sizeof(functionDef));
     result->name = name;
     result->isFunction = isFunction;
     result->parameters = getVarList();
+    result->nParams = 0;
+    result->sizeOnStack = 0;
     return result;
 }
 
 void freeFunctionDef(functionDef *fd) {
-    free(fd->name);
     freeVarList(fd->parameters);
     free(fd);
 }
@@ -112,14 +138,26 @@ void freeIFVs(internalFunctionVals *ifvs) {
 typedef struct interpreterRessources interpreterRessources;
 struct interpreterRessources {
     int returnVal;
-    char **markers;
+    symbolTable *markers;
     int nMarkers;
     int nGenericMarkers;
     varList *vars;
     functionDef **functions;
+    symbolTable *functionIndex;
     int nFunctions;
     internalFunctionVals *currentFunction;
-    char *name;
+    int visibleFunctions;
+    int name;
+    int endMarker;
+    FILE *output;
+    FILE *errors;
+    arena *tokens;
+    interner *symbols;
+    threadPool *pool;
+    procedureCache *cache;
+    phaseTimer *timer;
+    int optimize;
+    int verbose;
 };
 
 
@@ -127,19 +165,27 @@ void allocateInterpreterRessources(interpreterRessources *ir) {
     ir->returnVal = 0;
     ir->nMarkers = 0;
     ir->nGenericMarkers = 0;
-    ir->markers = malloc(0);
+    ir->markers = createSymbolTable();
     ir->vars = getVarList();
     ir->nFunctions = 0;
     ir->functions = malloc(0);
+    ir->functionIndex = createSymbolTable();
     ir->currentFunction = NULL;
-    ir->name = NULL;
+    ir->visibleFunctions = 0;
+    ir->name = -1;
+    ir->endMarker = -1;
+    ir->output = NULL;
+    ir->errors = stderr;
+    ir->tokens = NULL;
+    ir->symbols = NULL;
+    ir->pool = NULL;
+    ir->cache = NULL;
+    ir->timer = NULL;
+    ir->optimize = 0;
 }
 
 void freeIR(interpreterRessources *ir) {
-    for(int i = 0; i < ir->nMarkers; ++i) {
-        free(ir->markers[i]);
-    }
-    free(ir->markers);
+    freeSymbolTable(ir->markers);
 
     freeVarList(ir->vars);
     
@@ -147,6 +193,7 @@ void freeIR(interpreterRessources *ir) {
         freeFunctionDef(ir->functions[i]);
     }
     free(ir->functions);
+    freeSymbolTable(ir->functionIndex);
 }
 
 varList *getAdditionalVarList(interpreterRessources *ir, int canBeEmpty) {
@@ -154,7 +201,7 @@ varList *getAdditionalVarList(interpreterRessources *ir, int canBeEmpty) {
         internalFunctionVals *ifvs = ir->currentFunction;
         if(ifvs->internalVars == NULL) {
             ir->returnVal = 1;
-            fprintf(stderr, "The internal function values don't include additional variables!\n");
+            fprintf(ir->errors, "The internal function values don't include additional variables!\n");
             return NULL;
         }
         return ifvs->internalVars;
@@ -162,149 +209,504 @@ varList *getAdditionalVarList(interpreterRessources *ir, int canBeEmpty) {
         return NULL;
     } else {
         ir->returnVal = 1;
-        fprintf(stderr, "There is no current function!\n");
+        fprintf(ir->errors, "There is no current function!\n");
         return NULL;
     }
     
     return NULL;
 }
 
-typedef enum varCallType varCallType;
-enum varCallType {
-    callFailure,
-
-    singleValue,
-    valueInArray,
-    wholeArray,
-
-    singleValueLocal,
-    valueInArrayLocal,
-    wholeArrayLocal
-};
-varCallType resolveVarCall(parseToken *, interpreterRessources *);
+varCallType annotateVarCall(parseToken *, interpreterRessources *);
+varCallType resolveVarCall(parseToken *);
 varCallType collapseVCType(varCallType);
-int varCallIsLocal(parseToken *, interpreterRessources *);
-char *getLocalVarCall(parseToken *, interpreterRessources *);
-
-typedef enum expressionType expressionType;
-enum expressionType {
-    exprFailure,
-
-    computedValue,
-    singleValueVar,
-    literalValue,
-    array
-};
-
-int registerMarker(char *, interpreterRessources *);
-char *getNumberedMarker(interpreterRessources *);
-int registerVar(char *, int, int, interpreterRessources *, functionDef *);
+int varCallIsLocal(parseToken *);
+operand getLocalVarCall(parseToken *, interpreterRessources *, addressing);
+operand getVarName(parseToken *, interpreterRessources *, addressing);
+
+int markerIsFree(int, interpreterRessources *);
+int registerMarker(int, interpreterRessources *);
+int getNumberedMarker(interpreterRessources *);
+int getMarkerWithSuffix(int, char *, interpreterRessources *);
+int registerVar(int, int, int, interpreterRessources *, functionDef *);
 void registerPUSH(interpreterRessources *);
 void registerPULL(interpreterRessources *);
 void registerPUSHNr(interpreterRessources *, int);
 void registerPULLNr(interpreterRessources *, int);
-expressionType getExpressionType(parseToken *, interpreterRessources *);
-char *getExpressionCall(parseToken *, interpreterRessources *);
-int getLiteralExpressionValue(parseToken *tok, interpreterRessources *ir);
-char *varAddressInSP(parseToken *, interpreterRessources *);
+expressionType annotateExpression(parseToken *, interpreterRessources *);
+void annotateTree(parseToken *, interpreterRessources *);
+expressionType getExpressionType(parseToken *);
+operand getExpressionCall(parseToken *, interpreterRessources *);
+int getLiteralExpressionValue(parseToken *tok);
+void varAddressInSP(parseToken *, interpreterRessources *, instructionList *);
 parseToken *getExpressionUnderlyingVarCall(parseToken *, interpreterRessources *);
-int getArraySize(parseToken *, interpreterRessources *);
-
-char *getProgram(parseToken *, interpreterRessources *);
-char *getProcedures(parseToken *, interpreterRessources *);
-char *getProcedure(parseToken *, interpreterRessources *);
-char *getProcedureCall(parseToken *, interpreterRessources *, int);
-char *getBody(parseToken *, char *, interpreterRessources *);
+int getArraySize(parseToken *);
+
+const char *getName(int, interpreterRessources *);
+int checkSection(parseToken *, interpreterRessources *);
+parseToken *simplifySection(parseToken *, int, interpreterRessources *);
+void optimizeSection(instructionList *, interpreterRessources *);
+void emitSection(instructionList *, interpreterRessources *);
+void emitText(outputBuffer *, interpreterRessources *);
+void getProgram(parseToken *, interpreterRessources *, instructionList *);
+void getProcedures(parseToken *, interpreterRessources *);
+functionDef *getProcedureSignature(parseToken *, interpreterRessources *, int *);
+void getProcedure(parseToken *, functionDef *, int, interpreterRessources *, instructionList *);
+void getProcedureCall(parseToken *, interpreterRessources *, int, instructionList *);
+void getBody(parseToken *, int, interpreterRessources *, instructionList *);
 void parseVars(parseToken *, interpreterRessources *);
-char *getGlobalVarString(interpreterRessources *);
-char *getInstructionSequence(parseToken *, interpreterRessources *);
-char *getInstruction(parseToken *, interpreterRessources *);
-char *getExpression(parseToken *, interpreterRessources *);
-char *getCondition(parseToken *, char *, interpreterRessources *, int);
+void getGlobalVarString(interpreterRessources *, instructionList *);
+void getInstructionSequence(parseToken *, interpreterRessources *, instructionList *);
+void getInstruction(parseToken *, interpreterRessources *, instructionList *);
+void getExpression(parseToken *, interpreterRessources *, instructionList *);
+void getCondition(parseToken *, int, interpreterRessources *, int, instructionList *);
 
-char *createAssembly(parseToken *programToken, int *returnVal) {
+void createAssembly(parseToken *programToken, arena *tokens, interner *symbols, threadPool *pool,
+        procedureCache *cache, phaseTimer *timer, int optimize, int verbose, FILE *output,
+        FILE *errors, int *returnVal) {
+    enterPhase(timer, phaseCodegen);
+    
     interpreterRessources ir;
     allocateInterpreterRessources(&ir);
-    char *result = getProgram(programToken, &ir);
+    ir.output = output;
+    ir.errors = errors;
+    ir.tokens = tokens;
+    ir.symbols = symbols;
+    ir.pool = pool;
+    ir.cache = cache;
+    ir.timer = timer;
+    ir.optimize = optimize;
+    ir.verbose = verbose;
+    
+    if(cache != NULL) {
+        startCacheGeneration(cache);
+    }
+    
+    instructionList *result = createInstructions();
+    getProgram(programToken, &ir, result);
+    emitSection(result, &ir);
+    freeInstructions(result);
+    
     *returnVal = ir.returnVal;
     
     freeIR(&ir);
+    leavePhase(timer);
+}
 
-    return result;
+void writeAssembly(outputBuffer *text, interpreterRessources *ir) {
+    if(!flushBuffer(text, ir->output)) {
+        ir->returnVal = 1;
+        fprintf(ir->errors, "The assembly couldn't be written to the output!\n");
+    }
 }
 
-char *createFirstCommand(char *name) {
-    char *result = createStr();
+void reportDeadCode(deadCodeReport *report, int name, interpreterRessources *ir) {
+    const char *section = getName(name, ir);
+    
+    if(report->afterReturn > 0) {
+        fprintf(ir->errors, "%s: unreachable statements after RETURN removed: %i\n", section,
+                report->afterReturn);
+    }
+    if(report->constantConditions > 0) {
+        fprintf(ir->errors, "%s: IF, WHILE and REPEAT statements with a constant condition folded: %i\n",
+                section, report->constantConditions);
+    }
+    if(report->emptyStatements > 0) {
+        fprintf(ir->errors, "%s: empty IF statements removed: %i\n", section,
+                report->emptyStatements);
+    }
+}
 
-    result = catStrs(result, "\tJMP\t\t");
-    result = catStrs(result, name);
-    result = catStrs(result, "$Start\n");
+// Most errors are only found while the code is generated, so the removed statements have to be
+// generated as well. The section is generated without keeping the code or the errors, and without
+// changing the stack or the numbered markers of the section. Returns whether it has no errors.
+int checkSection(parseToken *tok, interpreterRessources *ir) {
+    char *errors = NULL;
+    size_t errorsLength = 0;
+    FILE *discarded = open_memstream(&errors, &errorsLength);
+    if(discarded == NULL) {
+        return 0;
+    }
+    
+    FILE *originalErrors = ir->errors;
+    int sizeVarsOnStack = ir->currentFunction != NULL ? ir->currentFunction->sizeVarsOnStack : 0;
+    int nGenericMarkers = ir->nGenericMarkers;
+    instructionList *code = createInstructions();
+    
+    ir->errors = discarded;
+    getInstructionSequence(tok, ir, code);
+    int success = ir->returnVal == 0;
+    
+    ir->errors = originalErrors;
+    ir->returnVal = 0;
+    if(ir->currentFunction != NULL) {
+        ir->currentFunction->sizeVarsOnStack = sizeVarsOnStack;
+    }
+    ir->nGenericMarkers = nGenericMarkers;
+    freeInstructions(code);
+    fclose(discarded);
+    free(errors);
+    return success;
+}
 
-    return result;
+// Simplifies the expressions of a body or procedure once they are annotated and removes the
+// statements that can never run. With -v it is reported what was removed. Returns the instructions
+// to generate: the section itself without -O, otherwise a simplified copy in ir->tokens. The parse
+// tree is shared by all jobs and outlives their arenas, so it is never rewritten. If statements
+// are removed, but the section has errors, the section itself is returned, so the errors are
+// reported like without -O.
+parseToken *simplifySection(parseToken *tok, int name, interpreterRessources *ir) {
+    if(!ir->optimize || ir->returnVal != 0) {
+        return tok;
+    }
+    
+    deadCodeReport report = {0, 0, 0};
+    
+    enterPhase(ir->timer, phaseOptimization);
+    parseToken *simplified = copyTree(ir->tokens, tok);
+    simplifyTree(simplified, ir->tokens);
+    simplified = removeDeadCode(simplified, ir->tokens, &report);
+    leavePhase(ir->timer);
+    
+    if(report.afterReturn + report.constantConditions + report.emptyStatements > 0
+            && !checkSection(tok, ir)) {
+        return tok;
+    }
+    
+    if(ir->verbose) {
+        reportDeadCode(&report, name, ir);
+    }
+    return simplified;
+}
+
+void optimizeSection(instructionList *section, interpreterRessources *ir) {
+    if(!ir->optimize || ir->returnVal != 0) {
+        return;
+    }
+    
+    enterPhase(ir->timer, phaseOptimization);
+    optimizeInstructions(section);
+    leavePhase(ir->timer);
+}
+
+// Prints the finished instructions of a section as assembly and writes them to the output
+void emitSection(instructionList *section, interpreterRessources *ir) {
+    if(ir->returnVal != 0) {
+        clearInstructions(section);
+        return;
+    }
+    
+    enterPhase(ir->timer, phaseOutput);
+    outputBuffer *text = createBuffer();
+    printInstructions(section, ir->symbols, text);
+    clearInstructions(section);
+    writeAssembly(text, ir);
+    freeBuffer(text);
+    leavePhase(ir->timer);
+}
+
+void emitText(outputBuffer *text, interpreterRessources *ir) {
+    if(ir->returnVal != 0) {
+        clearBuffer(text);
+        return;
+    }
+    
+    enterPhase(ir->timer, phaseOutput);
+    writeAssembly(text, ir);
+    leavePhase(ir->timer);
+}
+
+const char *getName(int name, interpreterRessources *ir) {
+    return symbolName(ir->symbols, name);
 }
 
-char *getProgram(parseToken *tok, interpreterRessources *ir) {
+void createFirstCommand(int name, interpreterRessources *ir, instructionList *result) {
+    int start = getMarkerWithSuffix(name, "$Start", ir);
+    appendInstruction(result, opJmp, symbolOperand(addressAbsolute, start));
+}
+
+void getProgram(parseToken *tok, interpreterRessources *ir, instructionList *result) {
     if(tok->type != program) {
         ir->returnVal = 1;
-        fprintf(stderr, "The first token is not a program, but a %s!\n",
+        fprintf(ir->errors, "The first token is not a program, but a %s!\n",
                 stringFromParseType(tok->type));
-        return createStr();
+        return;
     }
 
-    char *name = tok->values[0].name;
+    int name = tok->values[0].name;
     ir->name = name;
 
-    char *result = createStr();
-
-    char *firstCommand = createFirstCommand(name);
-    result = catStrs(result, firstCommand);
-    free(firstCommand);
+    createFirstCommand(name, ir, result);
+    emitSection(result, ir);
     
+    enterPhase(ir->timer, phaseVariables);
     parseVars(tok->subNodes[0], ir);
+    leavePhase(ir->timer);
+    
+    getProcedures(tok->subNodes[1], ir);
     
-    char *procedures = getProcedures(tok->subNodes[1], ir);
-    result = catStrs(result, procedures);
-    free(procedures);
+    ir->visibleFunctions = ir->nFunctions;
 
-    char *body = getBody(tok->subNodes[2], name, ir);
-    result = catStrs(result, body);
-    free(body);
+    enterPhase(ir->timer, phaseBody);
+    getBody(tok->subNodes[2], name, ir, result);
+    leavePhase(ir->timer);
+    optimizeSection(result, ir);
+    emitSection(result, ir);
 
-    char *pVars = getGlobalVarString(ir);
-    result = catStrs(result, pVars);
-    free(pVars);
+    getGlobalVarString(ir, result);
+    emitSection(result, ir);
+}
 
+// The number of numbered markers the instructions use, so every procedure can start its own
+// numbering without waiting for the procedures before it
+int countNumberedMarkers(parseToken *tok) {
+    int result;
+    
+    switch(tok->type) {
+        case instructionSequence:
+        case elseSection:
+            result = 0;
+            break;
+        case whileLoop:
+        case forLoop:
+            result = 2;
+            break;
+        case repeatLoop:
+            result = 1;
+            break;
+        case conditionalInstruction:
+            result = tok->subNodes[2]->nNodes > 0 ? 2 : 1;
+            break;
+        default:
+            return 0;
+    }
+    
+    for(int i = 0; i < tok->nNodes; ++i) {
+        result += countNumberedMarkers(tok->subNodes[i]);
+    }
+    
     return result;
 }
 
-char *getProcedures(parseToken *tok, interpreterRessources *ir) {
-    if(tok->type != procedures) {
-        ir->returnVal = 1;
-        fprintf(stderr, "The token is not a procedures, but a %s!\n",
-                stringFromParseType(tok->type));
-        return createStr();
+procedureHash hashTree(parseToken *tok, interpreterRessources *ir, procedureHash hash) {
+    hash = addIntToHash(hash, tok->type);
+    hash = addIntToHash(hash, tok->nVal);
+    
+    for(int i = 0; i < tok->nVal; ++i) {
+        hash = addIntToHash(hash, tok->valueTypes[i]);
+        if(tok->valueTypes[i] == string) {
+            const char *name = getName(tok->values[i].name, ir);
+            hash = addToHash(hash, name, strlen(name) + 1);
+        } else {
+            hash = addIntToHash(hash, tok->values[i].value);
+        }
     }
+    
+    hash = addIntToHash(hash, tok->nNodes);
+    
+    for(int i = 0; i < tok->nNodes; ++i) {
+        hash = hashTree(tok->subNodes[i], ir, hash);
+    }
+    
+    return hash;
+}
 
-    if(tok->nNodes == 0) {
-        return createStr();
+procedureHash hashVarList(varList *vars, interpreterRessources *ir, procedureHash hash) {
+    hash = addIntToHash(hash, vars->nVars);
+    hash = addIntToHash(hash, vars->totalSize);
+    
+    for(int i = 0; i < vars->nVars; ++i) {
+        const char *name = getName(vars->vars[i], ir);
+        hash = addToHash(hash, name, strlen(name) + 1);
+        hash = addIntToHash(hash, vars->varIsArray[i]);
+        hash = addIntToHash(hash, vars->varIsReference[i]);
+        hash = addIntToHash(hash, vars->positions[i]);
     }
+    
+    return hash;
+}
 
-    char *result;
-    parseToken *newTok;
+// Everything outside of a procedure its code depends on: the program, the globals and the
+// signatures of all procedures
+procedureHash hashDependencies(interpreterRessources *ir) {
+    const char *programName = getName(ir->name, ir);
+    procedureHash hash = addToHash(EMPTY_HASH, programName, strlen(programName) + 1);
+    
+    hash = hashVarList(ir->vars, ir, hash);
+    hash = addIntToHash(hash, ir->nFunctions);
+    
+    for(int i = 0; i < ir->nFunctions; ++i) {
+        functionDef *function = ir->functions[i];
+        const char *name = getName(function->name, ir);
+        hash = addToHash(hash, name, strlen(name) + 1);
+        hash = addIntToHash(hash, function->isFunction);
+        hash = addIntToHash(hash, function->nParams);
+        hash = addIntToHash(hash, function->sizeOnStack);
+        hash = hashVarList(function->parameters, ir, hash);
+    }
+    
+    return hash;
+}
 
-    if(tok->nNodes == 2) {
-        result = getProcedures(tok->subNodes[0], ir);
-        newTok = tok->subNodes[1];
+typedef struct procedureJob procedureJob;
+struct procedureJob {
+    poolTask task;
+    parseToken *tok;
+    functionDef *function;
+    int endMarker;
+    interpreterRessources ir;
+    outputBuffer *result;
+    instructionList *code;
+    char *errors;
+    size_t errorsLength;
+    int markerBase;
+    int cacheable;
+    int cached;
+    procedureHash hash;
+    phaseTimer timer;
+};
+
+// Generates one procedure with its own copy of the ressources. Everything shared with the other
+// procedures (globals, signatures, markers and names) is only read.
+void runProcedureJob(void *argument) {
+    procedureJob *job = (procedureJob *) argument;
+    interpreterRessources *ir = &job->ir;
+    
+    FILE *errors = open_memstream(&job->errors, &job->errorsLength);
+    if(errors != NULL) {
+        ir->errors = errors;
+    }
+    ir->tokens = createArena();
+    job->result = createBuffer();
+    instructionList *code = createInstructions();
+    
+    enterPhase(ir->timer, phaseProcedures);
+    getProcedure(job->tok, job->function, job->endMarker, ir, code);
+    leavePhase(ir->timer);
+    optimizeSection(code, ir);
+    
+    // Printed here, so the text is ready for the output. The cache keeps the instructions.
+    enterPhase(ir->timer, phaseOutput);
+    printInstructions(code, ir->symbols, job->result);
+    leavePhase(ir->timer);
+    
+    if(job->cacheable) {
+        job->code = code;
     } else {
-        result = createStr();
-        newTok = tok->subNodes[0];
+        freeInstructions(code);
+    }
+    freeArena(ir->tokens);
+    if(errors != NULL) {
+        fclose(errors);
     }
+}
 
-    char *newProcedure = getProcedure(newTok, ir);
-    result = catStrs(result, newProcedure);
-    free(newProcedure);
+void getProcedures(parseToken *tok, interpreterRessources *ir) {
+    if(tok->type != procedures) {
+        ir->returnVal = 1;
+        fprintf(ir->errors, "The token is not a procedures, but a %s!\n",
+                stringFromParseType(tok->type));
+        return;
+    }
 
-    return result;
+    int nProcedures = tok->nNodes;
+    procedureJob *jobs = (procedureJob *) calloc(nProcedures, sizeof(procedureJob));
+    
+    if(jobs == NULL) {
+        ir->returnVal = 1;
+        fprintf(ir->errors, "Couldn't assign memory to generate the procedures!\n");
+        return;
+    }
+    
+    int nMarkers = ir->nGenericMarkers;
+    
+    for(int i = 0; i < nProcedures; ++i) {
+        procedureJob *job = &jobs[i];
+        job->tok = tok->subNodes[i];
+        job->function = getProcedureSignature(job->tok, ir, &job->endMarker);
+        job->ir = *ir;
+        job->ir.visibleFunctions = ir->nFunctions;
+        // Each job is timed on its own thread and added to the total when it is done
+        initPhaseTimer(&job->timer);
+        job->ir.timer = ir->timer != NULL ? &job->timer : NULL;
+        job->ir.nGenericMarkers = nMarkers;
+        job->markerBase = nMarkers;
+        
+        if(job->function != NULL) {
+            nMarkers += countNumberedMarkers(job->tok->subNodes[3]);
+        }
+    }
+    
+    procedureHash dependencies = 0;
+    if(ir->cache != NULL) {
+        dependencies = hashDependencies(ir);
+    }
+    
+    for(int i = 0; i < nProcedures; ++i) {
+        procedureJob *job = &jobs[i];
+        job->ir.functions = ir->functions;
+        
+        if(job->function == NULL) {
+            continue;
+        }
+        
+        // The code generated after an error can't be reused, as it depends on that error
+        job->cacheable = ir->cache != NULL && job->ir.returnVal == 0;
+        
+        if(job->cacheable) {
+            job->hash = hashTree(job->tok, ir, addIntToHash(EMPTY_HASH, job->ir.visibleFunctions));
+            job->result = createBuffer();
+            job->cached = findCachedProcedure(ir->cache, job->hash, dependencies,
+                    job->markerBase, job->result, &job->errors, &job->errorsLength,
+                    &job->ir.returnVal);
+            
+            if(job->cached) {
+                continue;
+            }
+            freeBuffer(job->result);
+        }
+        
+        pausePhases(ir->timer);
+        submitTask(ir->pool, &job->task, runProcedureJob, job);
+        resumePhases(ir->timer);
+    }
+    
+    for(int i = 0; i < nProcedures; ++i) {
+        procedureJob *job = &jobs[i];
+        
+        if(job->function == NULL) {
+            continue;
+        }
+        
+        if(!job->cached) {
+            pausePhases(ir->timer);
+            waitForTask(ir->pool, &job->task);
+            resumePhases(ir->timer);
+            mergePhaseTimes(ir->timer, &job->timer);
+            
+            if(job->cacheable) {
+                storeCachedProcedure(ir->cache, job->hash, dependencies, job->markerBase,
+                        job->code, ir->symbols, job->errors, job->errorsLength,
+                        job->ir.returnVal);
+                freeInstructions(job->code);
+            }
+        }
+        
+        if(job->errors != NULL) {
+            fwrite(job->errors, 1, job->errorsLength, ir->errors);
+            free(job->errors);
+        }
+        
+        if(job->ir.returnVal != 0) {
+            ir->returnVal = 1;
+        }
+        
+        emitText(job->result, ir);
+        freeBuffer(job->result);
+    }
+    
+    ir->nGenericMarkers = nMarkers;
+    
+    free(jobs);
 }
 
 int resolveProcedureHeader(parseToken *tok, interpreterRessources *ir) {
@@ -314,7 +716,7 @@ int resolveProcedureHeader(parseToken *tok, interpreterRessources *ir) {
         return 1;
     } else {
         ir->returnVal = 1;
-        fprintf(stderr,
+        fprintf(ir->errors,
                 "The token is not a function- or procedure-header, but a %s!\n",
                 stringFromParseType(tok->type));
         return 0;
@@ -324,7 +726,7 @@ int resolveProcedureHeader(parseToken *tok, interpreterRessources *ir) {
 void parseParamDeclaration(parseToken *tok, interpreterRessources *ir, int reference, functionDef *functions) {
     if(tok->type != varDeclaration) {
         ir->returnVal = 1;
-        fprintf(stderr, "The token is not a varDeclaration, but a %s!\n",
+        fprintf(ir->errors, "The token is not a varDeclaration, but a %s!\n",
                 stringFromParseType(tok->type));
         return;
     }
@@ -335,7 +737,7 @@ void parseParamDeclaration(parseToken *tok, interpreterRessources *ir, int refer
         array = tok->values[1].value;
     }
 
-    char *name = tok->values[0].name;
+    int name = tok->values[0].name;
 
     registerVar(name, array, reference, ir, functions);
 }
@@ -343,7 +745,7 @@ void parseParamDeclaration(parseToken *tok, interpreterRessources *ir, int refer
 void parseParam(parseToken *tok, interpreterRessources *ir, functionDef *functions) {
     if(tok->type != copyParameter && tok->type != referenceParameter) {
         ir->returnVal = 1;
-        fprintf(stderr, "The token is not a copy- or reference-parameter, but a %s!\n",
+        fprintf(ir->errors, "The token is not a copy- or reference-parameter, but a %s!\n",
                 stringFromParseType(tok->type));
         return;
     }
@@ -356,25 +758,14 @@ void parseParam(parseToken *tok, interpreterRessources *ir, functionDef *functio
 void parseParams(parseToken *tok, interpreterRessources *ir, functionDef *functions) {
     if(tok->type != paramList) {
         ir->returnVal = 1;
-        fprintf(stderr, "The token is not a paramList, but a %s!\n",
+        fprintf(ir->errors, "The token is not a paramList, but a %s!\n",
                 stringFromParseType(tok->type));
         return;
     }
 
-    parseToken *param;
-
-    if(tok->nNodes == 2) {
-        parseParams(tok->subNodes[0], ir, functions);
-        param = tok->subNodes[1];
-    } else {
-        param = tok->subNodes[0];
-    }
-
-    if(tok->nNodes == 0) {
-        return;
+    for(int i = 0; i < tok->nNodes; ++i) {
+        parseParam(tok->subNodes[i], ir, functions);
     }
-    
-    parseParam(param, ir, functions);
 }
 
 int getSizeOnStack(varList *list) {
@@ -396,60 +787,65 @@ int testForNeededReturn(parseToken *tok, interpreterRessources *ir) {
         return 0;
     }
     
-    parseToken *instruction = tok->subNodes[0];
-    
-    if(instruction->type == returnStatement) {
-        return 1;
-    } else if(instruction->type == repeatLoop) {
-        parseToken *internalInstructions = instruction->subNodes[0];
-        if(testForNeededReturn(internalInstructions, ir)) {
-            return 1;
-        }
-    } else if(instruction->type == conditionalInstruction) {
-        int thenReturn = testForNeededReturn(instruction->subNodes[1], ir);
-        
-        parseToken *elseSection = instruction->subNodes[2];
-        int elseReturn = 1;
+    for(int i = 0; i < tok->nNodes; ++i) {
+        parseToken *instruction = tok->subNodes[i];
         
-        if(elseSection->nNodes == 1) {
-            elseReturn = testForNeededReturn(elseSection->subNodes[0], ir);
-        }
-        
-        if(thenReturn && elseReturn) {
+        if(instruction->type == returnStatement) {
             return 1;
+        } else if(instruction->type == repeatLoop) {
+            parseToken *internalInstructions = instruction->subNodes[0];
+            if(testForNeededReturn(internalInstructions, ir)) {
+                return 1;
+            }
+        } else if(instruction->type == conditionalInstruction) {
+            int thenReturn = testForNeededReturn(instruction->subNodes[1], ir);
+            
+            parseToken *elseSection = instruction->subNodes[2];
+            int elseReturn = 1;
+            
+            if(elseSection->nNodes == 1) {
+                elseReturn = testForNeededReturn(elseSection->subNodes[0], ir);
+            }
+            
+            if(thenReturn && elseReturn) {
+                return 1;
+            }
         }
     }
     
-    if(tok->nNodes == 2) {
-        return testForNeededReturn(tok->subNodes[1], ir);
-    } else {
-        return 0;
-    }
+    return 0;
 }
 
-char *getProcedure(parseToken *tok, interpreterRessources *ir) {
+functionDef *getProcedureSignature(parseToken *tok, interpreterRessources *ir, int *endMarker) {
     if(tok->type != procedure) {
         ir->returnVal = 1;
-        fprintf(stderr, "The token is not a procedure, but a %s!\n",
+        fprintf(ir->errors, "The token is not a procedure, but a %s!\n",
                stringFromParseType(tok->type));
-        return createStr();
+        return NULL;
     }
 
-    char *name = tok->values[0].name;
-    char *confirm = tok->values[1].name;
+    int name = tok->values[0].name;
+    int confirm = tok->values[1].name;
 
-    if(strcmp(name, confirm) != 0) {
+    if(name != confirm) {
         ir->returnVal = 1;
-        fprintf(stderr,
+        fprintf(ir->errors,
                 "The name of the procedure (\"%s\") doesn't match the name at the end of the body (\"%s\")!\n",
-                name, confirm);
-        return createStr();
+                getName(name, ir), getName(confirm, ir));
+        return NULL;
     }
 
     int function = resolveProcedureHeader(tok->subNodes[0], ir);
 
     if(ir->returnVal != 0) {
-        return createStr();
+        return NULL;
+    }
+    
+    if(lookupSymbol(ir->functionIndex, name) >= 0) {
+        ir->returnVal = 1;
+        fprintf(ir->errors, "The function or procedure with the name \"%s\" does already exist!\n",
+                getName(name, ir));
+        return NULL;
     }
     
     int nr = ++(ir->nFunctions);
@@ -457,92 +853,90 @@ char *getProcedure(parseToken *tok, interpreterRessources *ir) {
 
     if(tmp == NULL) {
         ir->returnVal = 1;
-        fprintf(stderr, "Couldn't assign memory to create function %s!\n", name);
+        fprintf(ir->errors, "Couldn't assign memory to create function %s!\n", getName(name, ir));
         --(ir->nFunctions);
-        return createStr();
+        return NULL;
     }
 
     ir->functions = tmp;
     
     functionDef *def = createFunction(name, function);
     ir->functions[nr - 1] = def;
+    insertSymbol(ir->functionIndex, name, nr - 1);
     
+    enterPhase(ir->timer, phaseVariables);
     parseParams(tok->subNodes[1], ir, def);
+    leavePhase(ir->timer);
+    
+    def->nParams = def->parameters->nVars;
+    def->sizeOnStack = getSizeOnStack(def->parameters);
+    
+    int markerSuccess = registerMarker(name, ir);
+    
+    *endMarker = getMarkerWithSuffix(name, "$End", ir);
+    
+    int endMarkerSuccess = registerMarker(*endMarker, ir);
+    
+    if(!markerSuccess || !endMarkerSuccess) {
+        return NULL;
+    }
+    
+    return def;
+}
+
+void getProcedure(parseToken *tok, functionDef *def, int endMarker, interpreterRessources *ir,
+        instructionList *result) {
+    int name = def->name;
     
     internalFunctionVals* ifvs = getIFVs(def);
     ir->currentFunction = ifvs;
     
     varList *procVars = ifvs->internalVars;
 
-    ifvs->sizeParams = getSizeOnStack(procVars);
-    ifvs->nParams = procVars->nVars;
+    ifvs->sizeParams = def->sizeOnStack;
+    ifvs->nParams = def->nParams;
     
+    enterPhase(ir->timer, phaseVariables);
     parseVars(tok->subNodes[2], ir);
+    leavePhase(ir->timer);
 
     ifvs->sizeVarsOnStack = getSizeOnStack(procVars) + 1;
     
-    if(function) {
+    if(def->isFunction) {
         int containsReturn = testForNeededReturn(tok->subNodes[3], ir);
         if(!containsReturn) {
             ir->returnVal = 1;
-            fprintf(stderr, "The function %s doesn't return a value on every path!\n", name);
-            return createStr();
+            fprintf(ir->errors, "The function %s doesn't return a value on every path!\n", getName(name, ir));
+            ir->currentFunction = NULL;
+            freeIFVs(ifvs);
+            return;
         }
     }
     
-    int markerSuccess = registerMarker(name, ir);
-    
-    char *endMarker = createStr();
-    endMarker = catStrs(endMarker, name);
-    endMarker = catStrs(endMarker, "$End");
-    
-    int endMarkerSuccess = registerMarker(endMarker, ir);
-    
-    if(!markerSuccess || !endMarkerSuccess) {
-        free(endMarker);
-        return createStr();
-    }
-    
-    char *result = createStr();
+    annotateTree(tok->subNodes[3], ir);
+    parseToken *instructions = simplifySection(tok->subNodes[3], name, ir);
     
-    result = catStrs(result, name);
-    result = catStrs(result, ":\n");
+    appendLabel(result, symbolOperand(addressAbsolute, name));
     
     int nrInternalVars = ifvs->sizeVarsOnStack - ifvs->sizeParams - 1;
     
     if(nrInternalVars > 0) {
-        result = catStrs(result, "\tRSV\t\t");
-        
-        char *nr = itostr(nrInternalVars);
-        result = catStrs(result, nr);
-        free(nr);
-        
-        result = catStrs(result, "\n");
+        appendInstruction(result, opRsv, numberOperand(addressAbsolute, nrInternalVars));
     }
     
-    char *body = getInstructionSequence(tok->subNodes[3], ir);
-    result = catStrs(result, body);
-    free(body);
+    ir->endMarker = endMarker;
+    getInstructionSequence(instructions, ir, result);
     
-    result = catStrs(result, endMarker);
-    result = catStrs(result, ":\n");
+    appendLabel(result, symbolOperand(addressAbsolute, endMarker));
     
     if(nrInternalVars > 0) {
-        result = catStrs(result, "\tREL\t\t$");
-        
-        char *nr = itostr(nrInternalVars);
-        result = catStrs(result, nr);
-        free(nr);
-        
-        result = catStrs(result, "\n");
+        appendInstruction(result, opRel, numberOperand(addressImmediate, nrInternalVars));
     }
     
-    result = catStrs(result, "\tRTS\n");
+    appendInstruction(result, opRts, noOperand);
     
     ir->currentFunction = NULL;
     freeIFVs(ifvs);
-    
-    return result;
 }
 
 parseToken *getExpressionUnderlyingVarCall(parseToken *tok, interpreterRessources *ir) {
@@ -563,186 +957,139 @@ parseToken *getExpressionUnderlyingVarCall(parseToken *tok, interpreterRessource
     }
 }
 
-char *parseCalledParam(parseToken *tok, interpreterRessources *ir, functionDef *func, int index) {
-    if(tok->type != paramListCall) {
-        ir->returnVal = 1;
-        fprintf(stderr, "The token is not a paramListCall, but a %s!\n",
-                stringFromParseType(tok->type));
-        return createStr();
-    }
-    
-    if((tok->nNodes == 0 && index > -1) || (tok->nNodes == 1 && index > 0)) {
-        ir->returnVal = 1;
-        fprintf(stderr, "Too few arguments when calling function %s!\n", func->name);
-        return createStr();
-    } else if (tok->nNodes > 0 && index < 0) {
-        ir->returnVal = 1;
-        fprintf(stderr, "Too much arguments when calling function %s!\n", func->name);
-    }
-    
-    if(index == -1) {
-        return createStr();
-    }
-    
-    char *result;
-    parseToken *expr;
-    if(tok->nNodes == 2) {
-        result = parseCalledParam(tok->subNodes[0], ir, func, index - 1);
-        expr = tok->subNodes[1];
-    } else {
-        result = createStr();
-        expr = tok->subNodes[0];
-    }
-    
-    char *name = func->parameters->vars[index];
+void parseCalledParam(parseToken *expr, interpreterRessources *ir, functionDef *func, int index,
+        instructionList *result) {
+    const char *name = getName(func->parameters->vars[index], ir);
     int reference = func->parameters->varIsReference[index];
-    int array = func->parameters->varIsArray[index];
-    
-    expressionType type = getExpressionType(expr, ir);
+    int arraySize = func->parameters->varIsArray[index];
+    expressionType type = getExpressionType(expr);
     parseToken *varCall = getExpressionUnderlyingVarCall(expr, ir);
     
-    if(!reference && !array) {
-        char *load = getExpression(expr, ir);
-        result = catStrs(result, load);
-        free(load);
+    if(!reference && !arraySize) {
+        getExpression(expr, ir, result);
         
-        result = catStrs(result, "\tPUSH\n");
+        appendInstruction(result, opPush, noOperand);
         registerPUSH(ir);
     }
     
-    if(array) {
+    if(arraySize) {
         if(type != array) {
             ir->returnVal = 1;
-            free(result);
-            fprintf(stderr, "The parameter \"%s\" of the function %s expects an array, but doesn't receive one!\n", name, func->name);
-            return createStr();
+            fprintf(ir->errors, "The parameter \"%s\" of the function %s expects an array, but doesn't receive one!\n", name, getName(func->name, ir));
+            return;
         }
         if(!reference) {
             
-            char *nameVar = varCall->values[0].name;
+            const char *nameVar = getName(varCall->values[0].name, ir);
             
-            int sizeVar = getArraySize(varCall, ir);
+            int sizeVar = getArraySize(varCall);
             
-            if(sizeVar != array) {
+            if(sizeVar != arraySize) {
                 ir->returnVal = 1;
-                fprintf(stderr, "An array with a size of %i (\"%s\") cannot be assigned to an array with the size of %i(\"%s\")!\n",
-                        sizeVar, nameVar, array, name);
-                return createStr();
+                fprintf(ir->errors, "An array with a size of %i (\"%s\") cannot be assigned to an array with the size of %i(\"%s\")!\n",
+                        sizeVar, nameVar, arraySize, name);
+                return;
             }
             
-            result = catStrs(result, "\tRSV\t\t");
-            char *sizeStr = itostr(array);
-            result = catStrs(result, sizeStr);
-            free(sizeStr);
-            result = catStrs(result, "\n");
-            registerPUSHNr(ir, array);
+            appendInstruction(result, opRsv, numberOperand(addressAbsolute, arraySize));
+            registerPUSHNr(ir, arraySize);
             
-            if(resolveVarCall(varCall, ir) > 3) {
-                nameVar = getLocalVarCall(varCall, ir);
-            }
-            
-            result = catStrs(result, "\tLOAD\t$");
-            result = catStrs(result, nameVar);
-            result = catStrs(result, "\n\tPUSH\n");
+            appendInstruction(result, opLoad, getVarName(varCall, ir, addressImmediate));
+            appendInstruction(result, opPush, noOperand);
             registerPUSH(ir);
             
-            for(int i = 0; i < array; ++i) {
+            for(int i = 0; i < arraySize; ++i) {
                 if(i > 0) {
-                    result = catStrs(result, "\tLOAD\t0(SP)\n");
-                    result = catStrs(result, "\tADD\t\t$1\n");
-                    result = catStrs(result, "\tSTORE\t0(SP)\n");
+                    appendInstruction(result, opLoad, stackOperand(addressAbsolute, 0));
+                    appendInstruction(result, opAdd, numberOperand(addressImmediate, 1));
+                    appendInstruction(result, opStore, stackOperand(addressAbsolute, 0));
                 }
-                result = catStrs(result, "\tLOAD\t@0(SP)\n");
-                result = catStrs(result, "\tSTORE\t");
-                
-                char *addressShift = itostr(i + 1);
-                result = catStrs(result, addressShift);
-                free(addressShift);
-                
-                result = catStrs(result, "(SP)\n");
+                appendInstruction(result, opLoad, stackOperand(addressIndirect, 0));
+                appendInstruction(result, opStore, stackOperand(addressAbsolute, i + 1));
             }
             
-            result = catStrs(result, "\tREL\t\t$1\n");
+            appendInstruction(result, opRel, numberOperand(addressImmediate, 1));
             registerPULL(ir);
             
-            return result;
+            return;
         }
     }
     
-    if(!array && type == array) {
+    if(!arraySize && type == array) {
         ir->returnVal = 1;
-        free(result);
-        fprintf(stderr, "The parameter \"%s\" of the function %s doesn't expect an array, but receives one!\n", name, func->name);
-        return createStr();
+        fprintf(ir->errors, "The parameter \"%s\" of the function %s doesn't expect an array, but receives one!\n", name, getName(func->name, ir));
+        return;
     }
     
     if(reference) {
         if(varCall == NULL) {
             ir->returnVal = 1;
-            free(result);
-            fprintf(stderr, "The parameter \"%s\" of the function %s expects a variable, but doesn't receive one!\n", name, func->name);
-            return createStr();
+            fprintf(ir->errors, "The parameter \"%s\" of the function %s expects a variable, but doesn't receive one!\n", name, getName(func->name, ir));
+            return;
         }
         
-        char *load = varAddressInSP(varCall, ir);
-        result = catStrs(result, load);
-        free(load);
+        varAddressInSP(varCall, ir, result);
     }
-    
-    return result;
 }
 
-char *getParamCall(parseToken *tok, interpreterRessources *ir, functionDef *func) {
-    int index = func->parameters->nVars - 1;
+void getParamCall(parseToken *tok, interpreterRessources *ir, functionDef *func, instructionList *result) {
+    if(tok->type != paramListCall) {
+        ir->returnVal = 1;
+        fprintf(ir->errors, "The token is not a paramListCall, but a %s!\n",
+                stringFromParseType(tok->type));
+        return;
+    }
+    
+    if(tok->nNodes < func->nParams) {
+        ir->returnVal = 1;
+        fprintf(ir->errors, "Too few arguments when calling function %s!\n", getName(func->name, ir));
+        return;
+    } else if(tok->nNodes > func->nParams) {
+        ir->returnVal = 1;
+        fprintf(ir->errors, "Too much arguments when calling function %s!\n", getName(func->name, ir));
+        return;
+    }
     
-    return parseCalledParam(tok, ir, func, index);
+    for(int i = 0; i < tok->nNodes; ++i) {
+        parseCalledParam(tok->subNodes[i], ir, func, i, result);
+    }
 }
 
-char *getProcedureCall(parseToken *tok, interpreterRessources *ir, int shouldBeFunction) {
+void getProcedureCall(parseToken *tok, interpreterRessources *ir, int shouldBeFunction, instructionList *result) {
     if(tok->type != procedureCall) {
         ir->returnVal = 1;
-        fprintf(stderr, "The token is not a procedureCall, but a %s!\n",
+        fprintf(ir->errors, "The token is not a procedureCall, but a %s!\n",
                 stringFromParseType(tok->type));
-        return createStr();
+        return;
     }
     
-    char *name = tok->values[0].name;
+    int name = tok->values[0].name;
     
-    functionDef *func = NULL;
+    int index = lookupSymbol(ir->functionIndex, name);
     
-    for(int i = 0; i < ir->nFunctions; ++i) {
-        functionDef *current = ir->functions[i];
-        if(strcmp(current->name, name) == 0) {
-            func = current;
-        }
-    }
-    
-    if(func == NULL) {
+    if(index < 0 || index >= ir->visibleFunctions) {
         ir->returnVal = 1;
-        fprintf(stderr, "There doesn't exist any function or procedure with the name \"%s\"!\n", name);
-        return createStr();
+        fprintf(ir->errors, "There doesn't exist any function or procedure with the name \"%s\"!\n",
+                getName(name, ir));
+        return;
     }
     
+    functionDef *func = ir->functions[index];
+    
     if(shouldBeFunction && !func->isFunction) {
         ir->returnVal = 1;
-        fprintf(stderr, "The procedure %s doesn't return any value!\n", name);
-        return createStr();
+        fprintf(ir->errors, "The procedure %s doesn't return any value!\n", getName(name, ir));
+        return;
     }
     
-    char *result = getParamCall(tok->subNodes[0], ir, func);
+    getParamCall(tok->subNodes[0], ir, func, result);
     
-    result = catStrs(result, "\tJSR\t\t");
-    result = catStrs(result, name);
-    result = catStrs(result, "\n");
-    result = catStrs(result, "\tREL\t\t$");
-    result = catStrs(result, itostr(getSizeOnStack(func->parameters)));
-    result = catStrs(result, "\n");
-    registerPULLNr(ir, getSizeOnStack(func->parameters));
-    
-    return result;
+    appendInstruction(result, opJsr, symbolOperand(addressAbsolute, name));
+    appendInstruction(result, opRel, numberOperand(addressImmediate, func->sizeOnStack));
+    registerPULLNr(ir, func->sizeOnStack);
 }
 
-char *getReturnStatement(parseToken *tok, interpreterRessources *ir) {
+void getReturnStatement(parseToken *tok, interpreterRessources *ir, instructionList *result) {
     int returnsValue = tok->nNodes == 1;
     int canReturnValue = 0;
     
@@ -752,130 +1099,108 @@ char *getReturnStatement(parseToken *tok, interpreterRessources *ir) {
     
     if(returnsValue && !canReturnValue) {
         ir->returnVal = 1;
-        fprintf(stderr, "The procedure %s tries to return a value, but is a non-returning procedure!\n",
-                ir->currentFunction->function->name);
-        return createStr();
+        fprintf(ir->errors, "The procedure %s tries to return a value, but is a non-returning procedure!\n",
+                getName(ir->currentFunction->function->name, ir));
+        return;
     }
     
     if(!returnsValue && canReturnValue) {
         ir->returnVal = 1;
-        fprintf(stderr, "The function %s tries to return without a value, but is a returning function!\n",
-                ir->currentFunction->function->name);
-        return createStr();
+        fprintf(ir->errors, "The function %s tries to return without a value, but is a returning function!\n",
+                getName(ir->currentFunction->function->name, ir));
+        return;
     }
     
-    char *result;
-    
     if(returnsValue) {
         parseToken *expr = tok->subNodes[0];
-        expressionType type = getExpressionType(expr, ir);
+        expressionType type = getExpressionType(expr);
         
         if(type == array) {
             ir->returnVal = 1;
-            fprintf(stderr, "A function can only return a single value, but \"%s\" tries to return an array!\n",
-                    ir->currentFunction->function->name);
-            return createStr();
+            fprintf(ir->errors, "A function can only return a single value, but \"%s\" tries to return an array!\n",
+                    getName(ir->currentFunction->function->name, ir));
+            return;
         }
         
-        result = getExpression(expr, ir);
-    } else {
-        result = createStr();
+        getExpression(expr, ir, result);
     }
-    
-    char *name;
-    
+
+    // The bounds of the FOR loops around the RETURN are still on the stack
     if(ir->currentFunction != NULL) {
-        name = ir->currentFunction->function->name;
-    } else {
-        name = ir->name;
+        internalFunctionVals *func = ir->currentFunction;
+        int pushed = func->sizeVarsOnStack - getSizeOnStack(func->internalVars) - 1;
+        if(pushed > 0) {
+            appendInstruction(result, opRel, numberOperand(addressImmediate, pushed));
+        }
     }
-    
-    result = catStrs(result, "\tJMP\t\t");
-    result = catStrs(result, name);
-    result = catStrs(result, "$End\n");
-    
-    return result;
+
+    appendInstruction(result, opJmp, symbolOperand(addressAbsolute, ir->endMarker));
 }
 
-char *createFirstMarker(char *name, interpreterRessources *ir) {
-    char *result = catStrs(createStr(), name);
-    result = catStrs(result, "$Start");
-    if(registerMarker(result, ir)) {
-        result = catStrs(result, ":\n");
-        return result;
-    } else {
-        free(result);
-        return createStr();
-    }
+int getMarkerWithSuffix(int name, char *suffix, interpreterRessources *ir) {
+    outputBuffer *marker = createBuffer();
+    appendStr(marker, getName(name, ir));
+    appendStr(marker, suffix);
+    int result = internName(ir->symbols, marker->str, marker->length);
+    freeBuffer(marker);
+    return result;
 }
 
-char *createHold(char *name, interpreterRessources *ir) {
-    char *result = catStrs(createStr(), name);
-    result = catStrs(result, "$End");
-    if(registerMarker(result, ir)) {
-        result = catStrs(result, ":\n");
-        result = catStrs(result, "\tHOLD\n");
-        return result;
-    } else {
-        free(result);
-        return createStr();
+int createMarkerWithSuffix(int name, char *suffix, interpreterRessources *ir, instructionList *result) {
+    int marker = getMarkerWithSuffix(name, suffix, ir);
+    if(registerMarker(marker, ir)) {
+        appendLabel(result, symbolOperand(addressAbsolute, marker));
+        return 1;
     }
+    return 0;
+}
 
+void createFirstMarker(int name, interpreterRessources *ir, instructionList *result) {
+    createMarkerWithSuffix(name, "$Start", ir, result);
 }
 
-char *getBody(parseToken *tok, char *name, interpreterRessources *ir) {
-    if(tok->type != body) {
-        ir->returnVal = 1;
-        fprintf(stderr, "The token is not a body, but a %s!\n",
-                stringFromParseType(tok->type));
-        return createStr();
-    }
-    if(strcmp(tok->values[0].name, name) != 0) {
-        ir->returnVal = 1;
-        fprintf(stderr,
-            "The name of the program (\"%s\") doesn't match the name in the body (\"%s\")!\n",
-                name, tok->values[0].name);
-        return createStr();
+void createHold(int name, interpreterRessources *ir, instructionList *result) {
+    if(createMarkerWithSuffix(name, "$End", ir, result)) {
+        appendInstruction(result, opHold, noOperand);
     }
-    
-    char *result = createFirstMarker(name, ir);
-    
-    char *instructions = getInstructionSequence(tok->subNodes[0], ir);
-    result = catStrs(result, instructions);
-    char *hold = createHold(name, ir);
-    result = catStrs(result, hold);
-    free(instructions);
-    free(hold);
-
-    return result;
 }
 
-void getVarDeclarations(parseToken *tok, interpreterRessources *ir) {
-    if(tok->type != varDeclarations) {
+void getBody(parseToken *tok, int name, interpreterRessources *ir, instructionList *result) {
+    if(tok->type != body) {
         ir->returnVal = 1;
-        fprintf(stderr,"The token is not a varDeclarations, but a %s!\n",
+        fprintf(ir->errors, "The token is not a body, but a %s!\n",
                 stringFromParseType(tok->type));
         return;
     }
-    
-    parseToken *var;
-
-    if(tok->nNodes == 1) {
-        var = tok->subNodes[0];
-    } else {
-        var = tok->subNodes[1];
-        getVarDeclarations(tok->subNodes[0], ir);
+    if(tok->values[0].name != name) {
+        ir->returnVal = 1;
+        fprintf(ir->errors,
+            "The name of the program (\"%s\") doesn't match the name in the body (\"%s\")!\n",
+                getName(name, ir), getName(tok->values[0].name, ir));
+        return;
     }
+    
+    annotateTree(tok->subNodes[0], ir);
+    parseToken *instructions = simplifySection(tok->subNodes[0], name, ir);
+    
+    createFirstMarker(name, ir, result);
+    
+    ir->endMarker = getMarkerWithSuffix(name, "$End", ir);
+    getInstructionSequence(instructions, ir, result);
+    
+    createHold(name, ir, result);
+}
 
+void getVarDeclaration(parseToken *var, interpreterRessources *ir) {
     if(var->type != varDeclaration) {
         ir->returnVal = 1;
-        fprintf(stderr,"The token is not a varDeclaration, but a %s!\n",
+        fprintf(ir->errors,"The token is not a varDeclaration, but a %s!\n",
             stringFromParseType(var->type));
         return;
     }
     
     int array = 0;
-    char *name = var->values[0].name;
+    int name = var->values[0].name;
     int nr = 1;
 
 
@@ -886,548 +1211,422 @@ void getVarDeclarations(parseToken *tok, interpreterRessources *ir) {
 
     if(nr < 1) {
         ir->returnVal = 1;
-        fprintf(stderr,
+        fprintf(ir->errors,
             "The size of an array has to be bigger than 0, but the array \"%s\" has a size of %i!\n",
-            name, nr);
+            getName(name, ir), nr);
         return;
     }
 
     registerVar(name, array, 0, ir, NULL);
 }
 
-void parseVars(parseToken *tok, interpreterRessources *ir) {
-    if(tok->type != varSections) {
+void getVarDeclarations(parseToken *tok, interpreterRessources *ir) {
+    if(tok->type != varDeclarations) {
         ir->returnVal = 1;
-        fprintf(stderr,"The token is not a varSections, but a %s!\n",
+        fprintf(ir->errors,"The token is not a varDeclarations, but a %s!\n",
                 stringFromParseType(tok->type));
         return;
     }
-    if(tok->nNodes == 0) {
-        return;
-    }
     
-    parseToken *subVarSection;
-
-    if(tok->nNodes == 1) {
-        subVarSection = tok->subNodes[0];
-    } else {
-        subVarSection = tok->subNodes[1];
-        parseVars(tok->subNodes[0], ir);
+    for(int i = 0; i < tok->nNodes; ++i) {
+        getVarDeclaration(tok->subNodes[i], ir);
     }
+}
 
-    if(subVarSection->type != varSection) {
+void parseVars(parseToken *tok, interpreterRessources *ir) {
+    if(tok->type != varSections) {
         ir->returnVal = 1;
-        fprintf(stderr,"The token is not a varSection, but a %s!\n",
-            stringFromParseType(subVarSection->type));
+        fprintf(ir->errors,"The token is not a varSections, but a %s!\n",
+                stringFromParseType(tok->type));
         return;
     }
-    
-    getVarDeclarations(subVarSection->subNodes[0], ir);
+    for(int i = 0; i < tok->nNodes; ++i) {
+        parseToken *subVarSection = tok->subNodes[i];
+        
+        if(subVarSection->type != varSection) {
+            ir->returnVal = 1;
+            fprintf(ir->errors,"The token is not a varSection, but a %s!\n",
+                stringFromParseType(subVarSection->type));
+            return;
+        }
+        
+        getVarDeclarations(subVarSection->subNodes[0], ir);
+    }
 }
 
-char *getGlobalVarString(interpreterRessources *ir) {
+void getGlobalVarString(interpreterRessources *ir, instructionList *result) {
     varList *vars = ir->vars;
 
-    char *result = createStr();
-
     for(int i = 0; i < vars->nVars; ++i) {
-        char *var = vars->vars[i];
         int array = vars->varIsArray[i];
-        result = catStrs(result, var);
-        result = catStrs(result, ":\n");
+        appendLabel(result, symbolOperand(addressAbsolute, vars->vars[i]));
 
         if(!array) {
             ++array;
         }
 
         for(; array > 0; --array) {
-            result = catStrs(result, "\tWORD\t0\n");
+            appendInstruction(result, opWord, numberOperand(addressAbsolute, 0));
         }
     }
-
-    return result;
 }
 
-char *getInstructionSequence(parseToken *tok, interpreterRessources *ir) {
+void getInstructionSequence(parseToken *tok, interpreterRessources *ir, instructionList *result) {
     if(tok->type != instructionSequence) {
         ir->returnVal = 1;
-        fprintf(stderr, "The token is not an instructionSequence, but a %s!\n",
+        fprintf(ir->errors, "The token is not an instructionSequence, but a %s!\n",
             stringFromParseType(tok->type));
-        return createStr();
+        return;
     }
 
-    char *result = getInstruction(tok->subNodes[0], ir);
-
-    if(tok->nNodes > 1) {
-        char *prevInstructions = getInstructionSequence(tok->subNodes[1], ir);
-        result = catStrs(result, prevInstructions);
-        free(prevInstructions);
+    for(int i = 0; i < tok->nNodes; ++i) {
+        getInstruction(tok->subNodes[i], ir, result);
     }
-
-    return result;
 }
 
-char *varAddressInSP(parseToken *tok, interpreterRessources *ir) {
-    char *name = tok->values[0].name;
-    
-    if(varCallIsLocal(tok, ir)) {
-        name = getLocalVarCall(tok, ir);
+operand getVarName(parseToken *tok, interpreterRessources *ir, addressing mode) {
+    if(varCallIsLocal(tok)) {
+        return getLocalVarCall(tok, ir, mode);
+    } else {
+        return symbolOperand(mode, tok->values[0].name);
     }
-    
+}
+
+void varAddressInSP(parseToken *tok, interpreterRessources *ir, instructionList *result) {
     int isNoArray = tok->nNodes == 0;
     
-    char *result = createStr();
-    
     if(!isNoArray) {
-        expressionType typeEx = getExpressionType(tok->subNodes[0], ir);
+        expressionType typeEx = getExpressionType(tok->subNodes[0]);
         
-        isNoArray = typeEx == literalValue && getLiteralExpressionValue(tok->subNodes[0], ir) == 0;
+        isNoArray = typeEx == literalValue && getLiteralExpressionValue(tok->subNodes[0]) == 0;
         
-        if(!(typeEx == exprFailure || typeEx == array)) {
-            char *expression = getExpression(tok->subNodes[0], ir);
-            result = catStrs(result, expression);
-            free(expression);
-        } else {
+        if(typeEx == exprFailure || typeEx == array) {
             if(typeEx == array) {
                 ir->returnVal = 1;
-                fprintf(stderr, "The index of the array \"%s\" cannot be a whole array itself!\n", name);
+                fprintf(ir->errors, "The index of the array \"%s\" cannot be a whole array itself!\n",
+                        getName(tok->values[0].name, ir));
             }
-            return result;
+            return;
+        }
+        
+        if(!isNoArray) {
+            getExpression(tok->subNodes[0], ir, result);
         }
     }
 
-    if(isNoArray) {
-        free(result);
-        result = catStrs(createStr(), "\tLOAD\t$");
-    } else {
-        result = catStrs(result, "\tADD\t\t$");
-    }
-
-    result = catStrs(result, name);
-    result = catStrs(result, "\n\tPUSH\n");
+    appendInstruction(result, isNoArray ? opLoad : opAdd, getVarName(tok, ir, addressImmediate));
+    appendInstruction(result, opPush, noOperand);
     registerPUSH(ir);
-
-    return result;
 }
 
-char *getInternalAssignment(parseToken *var, char *allocation, interpreterRessources *ir) {
-    varCallType leftType = collapseVCType(resolveVarCall(var, ir));
-
-    if(leftType == callFailure) {
-        return createStr();
-    }
-    
-    char *name = var->values[0].name;
+// Pushes the address of the array element the value is assigned to. The value has to be generated
+// after it, as the addresses relative to SP change with the push.
+varCallType beginAssignment(parseToken *var, interpreterRessources *ir, instructionList *result) {
+    varCallType leftType = collapseVCType(resolveVarCall(var));
     
-    if(varCallIsLocal(var, ir)) {
-        name = getLocalVarCall(var, ir);
+    if(leftType == 2) {
+        varAddressInSP(var, ir, result);
     }
+    return leftType;
+}
 
-    char *result;
-    
+// Stores the value in the accumulator in the variable of beginAssignment
+void endAssignment(parseToken *var, varCallType leftType, interpreterRessources *ir,
+        instructionList *result) {
     switch(leftType) {
         case 1:
-            result = allocation;
-            result = catStrs(result, "\tSTORE\t");
-            result = catStrs(result, name);
-            result = catStrs(result, "\n");
-            return result;
+            appendInstruction(result, opStore, getVarName(var, ir, addressAbsolute));
+            return;
         case 2:
-            result = varAddressInSP(var, ir);
-            result = catStrs(result, allocation);
-            free(allocation);
-            result = catStrs(result, "\tSTORE\t@0(SP)\n");
-            result = catStrs(result, "\tREL\t\t$1\n");
+            appendInstruction(result, opStore, stackOperand(addressIndirect, 0));
+            appendInstruction(result, opRel, numberOperand(addressImmediate, 1));
             registerPULL(ir);
-            return result;
+            return;
         default:
-            free(allocation);
-            return createStr();
+            return;
     }
-
 }
 
-int getArraySize(parseToken *tok, interpreterRessources *ir) {
+int getArraySize(parseToken *tok) {
     if(tok->type != varCall) {
         return 0;
     }
     
-    char *name = tok->values[0].name;
-    
-    varCallType type = resolveVarCall(tok, ir);
-    
-    varList *list = ir->vars;
-    
-    if(type > 3) {
-        list = ir->currentFunction->internalVars;
-    }
-    
-    for(int i = 0; i < list->nVars; ++i) {
-        if(strcmp(name, list->vars[i]) == 0) {
-            return list->varIsArray[i];
-        }
-    }
-    
-    return 0;
+    return tok->arraySize;
 }
 
-char *assignArray(parseToken *left, parseToken *right, int size, interpreterRessources *ir) {
-    char *result = createStr();
-    
-    char *nameLeft = left->values[0].name;
-    if(resolveVarCall(left, ir) > 3) {
-        nameLeft = getLocalVarCall(left, ir);
-    }
-    
-    result = catStrs(result, "\tLOAD\t$");
-    result = catStrs(result, nameLeft);
-    result = catStrs(result, "\n\tPUSH\n");
+void assignArray(parseToken *left, parseToken *right, int size, interpreterRessources *ir,
+        instructionList *result) {
+    appendInstruction(result, opLoad, getVarName(left, ir, addressImmediate));
+    appendInstruction(result, opPush, noOperand);
     registerPUSH(ir);
     
-    char *nameRight = right->values[0].name;
-    if(resolveVarCall(right, ir) > 3) {
-        nameRight = getLocalVarCall(right, ir);
-    }
-    
-    result = catStrs(result, "\tLOAD\t$");
-    result = catStrs(result, nameRight);
-    result = catStrs(result, "\n\tPUSH\n");
+    appendInstruction(result, opLoad, getVarName(right, ir, addressImmediate));
+    appendInstruction(result, opPush, noOperand);
     registerPUSH(ir);
     
     for(int i = 0; i < size; ++i) {
         if(i > 0) {
-            result = catStrs(result, "\tLOAD\t0(SP)\n");
-            result = catStrs(result, "\tADD\t\t$1\n");
-            result = catStrs(result, "\tSTORE\t0(SP)\n");
+            appendInstruction(result, opLoad, stackOperand(addressAbsolute, 0));
+            appendInstruction(result, opAdd, numberOperand(addressImmediate, 1));
+            appendInstruction(result, opStore, stackOperand(addressAbsolute, 0));
             
-            result = catStrs(result, "\tLOAD\t1(SP)\n");
-            result = catStrs(result, "\tADD\t\t$1\n");
-            result = catStrs(result, "\tSTORE\t1(SP)\n");
+            appendInstruction(result, opLoad, stackOperand(addressAbsolute, 1));
+            appendInstruction(result, opAdd, numberOperand(addressImmediate, 1));
+            appendInstruction(result, opStore, stackOperand(addressAbsolute, 1));
         }
         
-        result = catStrs(result, "\tLOAD\t@0(SP)\n");
-        result = catStrs(result, "\tSTORE\t@1(SP)\n");
+        appendInstruction(result, opLoad, stackOperand(addressIndirect, 0));
+        appendInstruction(result, opStore, stackOperand(addressIndirect, 1));
     }
     
-    result = catStrs(result, "\tREL\t\t$2\n");
+    appendInstruction(result, opRel, numberOperand(addressImmediate, 2));
     registerPULLNr(ir, 2);
-    
-    return result;
 }
 
-char *getAssignment(parseToken *tok, interpreterRessources *ir) {
+void getAssignment(parseToken *tok, interpreterRessources *ir, instructionList *result) {
     parseToken *var = tok->subNodes[0];
     parseToken *expr = tok->subNodes[1];
 
-    varCallType leftType = collapseVCType(resolveVarCall(var, ir));
-    expressionType rightType = getExpressionType(expr, ir);
+    varCallType leftType = collapseVCType(resolveVarCall(var));
+    expressionType rightType = getExpressionType(expr);
 
     if(leftType == callFailure || rightType == exprFailure) {
-        return createStr();
+        return;
     }
     
-    char *name = var->values[0].name;
+    const char *name = getName(var->values[0].name, ir);
 
     if(leftType == 3 && rightType != array) {
         ir->returnVal = 1;
-        fprintf(stderr, "A single value cannot be assigned to the array \"%s\"!\n", name);
-        return createStr();
+        fprintf(ir->errors, "A single value cannot be assigned to the array \"%s\"!\n", name);
+        return;
     } else if(leftType != 3 && rightType == array) {
         ir->returnVal = 1;
-        fprintf(stderr, "A whole array cannot be assigned to the single variable \"%s\"!\n", name);
-        return createStr();
+        fprintf(ir->errors, "A whole array cannot be assigned to the single variable \"%s\"!\n", name);
+        return;
     }
     
     if(rightType == array) {
         parseToken *array =getExpressionUnderlyingVarCall(expr, ir);
         
-        char *nameLeft = var->values[0].name;
-        char *nameRight = array->values[0].name;
+        const char *nameLeft = getName(var->values[0].name, ir);
+        const char *nameRight = getName(array->values[0].name, ir);
         
-        int sizeRight = getArraySize(array, ir);
-        int sizeLeft = getArraySize(var, ir);
+        int sizeRight = getArraySize(array);
+        int sizeLeft = getArraySize(var);
         
         if(sizeRight != sizeLeft) {
             ir->returnVal = 1;
-            fprintf(stderr, "An array with a size of %i (\"%s\") cannot be assigned to an array with the size of %i(\"%s\")!\n",
+            fprintf(ir->errors, "An array with a size of %i (\"%s\") cannot be assigned to an array with the size of %i(\"%s\")!\n",
                     sizeRight, nameRight, sizeLeft, nameLeft);
-            return createStr();
+            return;
         }
         
-        return assignArray(var, array, sizeLeft, ir);
+        assignArray(var, array, sizeLeft, ir, result);
     } else {
-        char *exprStr = getExpression(expr, ir);
-
-        return getInternalAssignment(var, exprStr, ir);
+        beginAssignment(var, ir, result);
+        getExpression(expr, ir, result);
+        endAssignment(var, leftType, ir, result);
     }
 }
 
-char *getWhileLoop(parseToken *tok, interpreterRessources *ir) {
+void getWhileLoop(parseToken *tok, interpreterRessources *ir, instructionList *result) {
     if(tok->type != whileLoop) {
         ir->returnVal = 1;
-        fprintf(stderr, "The token is not a whileLoop, but a %s!\n",
+        fprintf(ir->errors, "The token is not a whileLoop, but a %s!\n",
                 stringFromParseType(tok->type));
-        return createStr();
+        return;
     }
 
-    char *startMarker = getNumberedMarker(ir);
-    char *instructions = getInstructionSequence(tok->subNodes[1], ir);
+    int startMarker = getNumberedMarker(ir);
+    instructionList *instructions = createInstructions();
+    getInstructionSequence(tok->subNodes[1], ir, instructions);
 
-    char *endMarker = getNumberedMarker(ir);
+    int endMarker = getNumberedMarker(ir);
 
-    if(startMarker == NULL || endMarker == NULL) {
-        free(instructions);
-        if(startMarker != NULL) {
-            free(startMarker);
-        }
-        if(endMarker != NULL) {
-            free(endMarker);
-        }
-        return createStr();
+    if(startMarker < 0 || endMarker < 0) {
+        freeInstructions(instructions);
+        return;
     }
 
-    char *result = catStrs(createStr(), startMarker);
-    result = catStrs(result, ":\n");
+    appendLabel(result, markerOperand(startMarker));
     
-    char *condition = getCondition(tok->subNodes[0], endMarker, ir, 0);
-    result = catStrs(result, condition);
-    free(condition);
-
-    result = catStrs(result, instructions);
-    free(instructions);
+    getCondition(tok->subNodes[0], endMarker, ir, 0, result);
 
-    result = catStrs(result, "\tJMP\t\t");
-    result = catStrs(result, startMarker);
-    result = catStrs(result, "\n");
-    result = catStrs(result, endMarker);
-    result = catStrs(result, ":\n");
+    appendInstructions(result, instructions);
 
-    free(startMarker);
-    free(endMarker);
-
-    return result;
+    appendInstruction(result, opJmp, markerOperand(startMarker));
+    appendLabel(result, markerOperand(endMarker));
 }
 
-char *getConditionalInstruction(parseToken *tok, interpreterRessources *ir) {
+void getConditionalInstruction(parseToken *tok, interpreterRessources *ir, instructionList *result) {
     if(tok->type != conditionalInstruction) {
         ir->returnVal = 1;
-        fprintf(stderr, "The token is not a conditionalInstruction, but a %s!\n",
+        fprintf(ir->errors, "The token is not a conditionalInstruction, but a %s!\n",
                 stringFromParseType(tok->type));
-        return createStr();
+        return;
     }
 
     int elseExists = tok->subNodes[2]->nNodes > 0;
     
     
-    char *instructions = getInstructionSequence(tok->subNodes[1], ir);
-    char *elseMarker = getNumberedMarker(ir);
+    instructionList *instructions = createInstructions();
+    getInstructionSequence(tok->subNodes[1], ir, instructions);
+    int elseMarker = getNumberedMarker(ir);
 
-    char *endMarker = NULL;
-    char *elseSection = NULL;
+    int endMarker = -1;
+    instructionList *elseSection = NULL;
     if(elseExists) {
-        elseSection = getInstructionSequence(tok->subNodes[2]->subNodes[0], ir);
+        elseSection = createInstructions();
+        getInstructionSequence(tok->subNodes[2]->subNodes[0], ir, elseSection);
         endMarker = getNumberedMarker(ir);
     }
 
-    if(elseMarker == NULL || (endMarker == NULL && elseExists)) {
-        free(instructions);
-        if(elseMarker != NULL) {
-            free(elseMarker);
-        }
-        if(endMarker != NULL) {
-            free(endMarker);
-        }
-        if(elseSection != NULL) {
-            free(elseSection);
-        }
-        return createStr();
+    if(elseMarker < 0 || (endMarker < 0 && elseExists)) {
+        freeInstructions(instructions);
+        freeInstructions(elseSection);
+        return;
     }
 
-    char *result = getCondition(tok->subNodes[0], elseMarker, ir, 0);
+    getCondition(tok->subNodes[0], elseMarker, ir, 0, result);
 
-    result = catStrs(result, instructions);
-    free(instructions);
+    appendInstructions(result, instructions);
     
     if(elseExists) {
-        result = catStrs(result, "\tJMP\t\t");
-        result = catStrs(result, endMarker);
-        result = catStrs(result, "\n");
+        appendInstruction(result, opJmp, markerOperand(endMarker));
     }
     
-    result = catStrs(result, elseMarker);
-    result = catStrs(result, ":\n");
-    free(elseMarker);
+    appendLabel(result, markerOperand(elseMarker));
 
     if(elseExists) {
-        result = catStrs(result, elseSection);
-        free(elseSection);
+        appendInstructions(result, elseSection);
 
-        result = catStrs(result, endMarker);
-        result = catStrs(result, ":\n");
-        free(endMarker);
+        appendLabel(result, markerOperand(endMarker));
     }
-
-    return result;
 }
 
-char *getRepeatLoop(parseToken *tok, interpreterRessources *ir){
+void getRepeatLoop(parseToken *tok, interpreterRessources *ir, instructionList *result){
     if(tok->type != repeatLoop) {
         ir->returnVal = 1;
-        fprintf(stderr, "The token is not a repeatLoop, but a %s!\n",
+        fprintf(ir->errors, "The token is not a repeatLoop, but a %s!\n",
                 stringFromParseType(tok->type));
-        return createStr();
+        return;
     }
 
-    char *startMarker = getNumberedMarker(ir);
+    int startMarker = getNumberedMarker(ir);
 
-    if(startMarker == NULL) {
-        return createStr();
+    if(startMarker < 0) {
+        return;
     }
     
-    char *result = catStrs(createStr(), startMarker);
-    result = catStrs(result, ":\n");
-
-    char *instructions = getInstructionSequence(tok->subNodes[0], ir);
-    result = catStrs(result, instructions);
-    free(instructions);
-
-    char *condition = getCondition(tok->subNodes[1], startMarker, ir, 0);
-    result = catStrs(result, condition);
-    free(condition);
-
-    free(startMarker);
-    return result;
-}
+    appendLabel(result, markerOperand(startMarker));
 
-void prepareSpecialExpression(parseToken *expression) {
-    parseToken *valueTok = expression->subNodes[0];
-    valueTok->nNodes = 0;
-}
+    getInstructionSequence(tok->subNodes[0], ir, result);
 
-void freeSpecialAssignment(parseToken *assignment) {
-    assignment->subNodes[0] = assignment->subNodes[1];
-    assignment->nNodes = 1;
-    freeToken(assignment);
+    getCondition(tok->subNodes[1], startMarker, ir, 0, result);
 }
 
-char *getForLoop(parseToken *tok, interpreterRessources *ir) {
+void getForLoop(parseToken *tok, interpreterRessources *ir, instructionList *result) {
     if(tok->type != forLoop) {
         ir->returnVal = 1;
-        fprintf(stderr, "The token ist not a forLoop, but a%s!\n",
+        fprintf(ir->errors, "The token ist not a forLoop, but a%s!\n",
                 stringFromParseType(tok->type));
-        return createStr();
+        return;
     }
 
     parseToken *assignmentToken = tok->subNodes[0];
     parseToken *varCallToken = assignmentToken->subNodes[0];
 
-    if(resolveVarCall(varCallToken, ir) == 3) {
+    if(resolveVarCall(varCallToken) == 3) {
         ir->returnVal = 1;
-        fprintf(stderr, "The count var can't be a whole array!\n");
-        return createStr();
+        fprintf(ir->errors, "The count var can't be a whole array!\n");
+        return;
     }
 
-    parseToken *varExpression = createUnaryExpression(createValueByCall(varCallToken));
-    char *result = getAssignment(assignmentToken, ir);
+    parseToken *varExpression = createUnaryExpression(ir->tokens, createValueByCall(ir->tokens, varCallToken));
+    annotateExpression(varExpression, ir);
+    getAssignment(assignmentToken, ir, result);
 
     parseToken *targetToken = tok->subNodes[1];
-    char *target = getExpression(targetToken, ir);
-    result = catStrs(result, target);
-    free(target);
-    result = catStrs(result, "\tPUSH\n");
+    getExpression(targetToken, ir, result);
+    appendInstruction(result, opPush, noOperand);
     registerPUSH(ir);
 
-    char *marker = getNumberedMarker(ir);
-    if(marker == NULL) {
-        free(result);
-        return createStr();
+    int marker = getNumberedMarker(ir);
+    if(marker < 0) {
+        return;
     }
 
-    result = catStrs(result, marker);
-    result = catStrs(result, ":\n");
+    appendLabel(result, markerOperand(marker));
 
-    char *varCall = getExpression(varExpression, ir);
-    result = catStrs(result,varCall);
+    getExpression(varExpression, ir, result);
     
-    result = catStrs(result, "\tCMP\t\t0(SP)\n");
+    appendInstruction(result, opCmp, stackOperand(addressAbsolute, 0));
     
     parseToken *iteration = tok->subNodes[2];
     parseToken *instructionSequence = tok->subNodes[3];
 
-    char *instructions = getInstructionSequence(instructionSequence, ir);
-
-    char *endMarker = getNumberedMarker(ir);
-
-    if(endMarker == NULL) {
-        free(result);
-        free(instructions);
-        return createStr();
-    }
+    instructionList *instructions = createInstructions();
+    getInstructionSequence(instructionSequence, ir, instructions);
 
-    int negative = 0;
+    int endMarker = getNumberedMarker(ir);
 
-    if(iteration->type != negativeAdvancement) {
-        result = catStrs(result, "\tJMPP\t");
-    } else {
-        negative = 1;
-        result = catStrs(result, "\tJMPN\t");
+    if(endMarker < 0) {
+        freeInstructions(instructions);
+        return;
     }
 
-    result = catStrs(result, endMarker);
-    result = catStrs(result, "\n");
+    int negative = iteration->type == negativeAdvancement;
 
-    result = catStrs(result, instructions);
-    free(instructions);
+    appendInstruction(result, negative ? opJmpn : opJmpp, markerOperand(endMarker));
 
-    parseToken *rightPart = createUnaryExpression(createValue(iteration->values[0].value));
-    parseToken *binaryExpression = createBinaryExpression(varExpression, negative, rightPart);
+    appendInstructions(result, instructions);
 
-    char *exprStr = getExpression(binaryExpression, ir);
-    exprStr = catStrs(exprStr, "\tJMPV\t");
-    exprStr = catStrs(exprStr, endMarker);
-    exprStr = catStrs(exprStr, "\n");
+    parseToken *rightPart = createUnaryExpression(ir->tokens, createValue(ir->tokens, iteration->values[0].value));
+    parseToken *binaryExpression = createBinaryExpression(ir->tokens, varExpression, negative, rightPart);
+    annotateExpression(binaryExpression, ir);
 
-    char *iterationStr = getInternalAssignment(varCallToken, exprStr, ir);
-    result = catStrs(result, iterationStr);
-    free(iterationStr);
+    varCallType counterType = beginAssignment(varCallToken, ir, result);
+    getExpression(binaryExpression, ir, result);
+    appendInstruction(result, opJmpv, markerOperand(endMarker));
+    endAssignment(varCallToken, counterType, ir, result);
 
-    result = catStrs(result, "\tJMP\t\t");
-    result = catStrs(result, marker);
-    result = catStrs(result, "\n");
-    result = catStrs(result, endMarker);
-    result = catStrs(result, ":\n");
+    appendInstruction(result, opJmp, markerOperand(marker));
+    appendLabel(result, markerOperand(endMarker));
 
-    result = catStrs(result, "\tREL\t\t$1\n");
+    appendInstruction(result, opRel, numberOperand(addressImmediate, 1));
     registerPULL(ir);
-
-    prepareSpecialExpression(varExpression);
-    free(marker);
-    free(endMarker);
-    free(varCall);
-    return result;
 }
 
-char *getInstruction(parseToken *tok, interpreterRessources *ir) {
+void getInstruction(parseToken *tok, interpreterRessources *ir, instructionList *result) {
     switch(tok->type) {
         case assignment:
-            return getAssignment(tok, ir);
+            getAssignment(tok, ir, result);
+            return;
         case whileLoop:
-            return getWhileLoop(tok, ir);
+            getWhileLoop(tok, ir, result);
+            return;
         case conditionalInstruction:
-            return getConditionalInstruction(tok, ir);
+            getConditionalInstruction(tok, ir, result);
+            return;
         case repeatLoop:
-            return getRepeatLoop(tok, ir);
+            getRepeatLoop(tok, ir, result);
+            return;
         case forLoop:
-            return getForLoop(tok, ir);
+            getForLoop(tok, ir, result);
+            return;
         case procedureCall:
-            return getProcedureCall(tok, ir, 0);
+            getProcedureCall(tok, ir, 0, result);
+            return;
         case returnStatement:
-            return getReturnStatement(tok, ir);
+            getReturnStatement(tok, ir, result);
+            return;
         default:
             ir->returnVal = 1;
-            fprintf(stderr, "The token is not an instruction, but a %s!\n",
+            fprintf(ir->errors, "The token is not an instruction, but a %s!\n",
                     stringFromParseType(tok->type));
-            return createStr();
+            return;
     }
 }
 
@@ -1446,52 +1645,56 @@ int canBeOnSP(parseToken *tok) {
     return 0;
 }
 
-char *getOnSP(parseToken *tok, interpreterRessources *ir) {
+void getOnSP(parseToken *tok, interpreterRessources *ir, instructionList *result) {
     if((tok->type == expression && tok->nNodes == 1) || (tok->type == value && tok->nNodes > 0)) {
-        return getOnSP(tok->subNodes[0], ir);
+        getOnSP(tok->subNodes[0], ir, result);
+        return;
     }
     if(tok->type == arrayCall) {
-        return varAddressInSP(tok, ir);
+        varAddressInSP(tok, ir, result);
+    }
+}
+
+// Loads the first operand of an operation, 0 if there is none
+void loadFirstOperand(parseToken *first, interpreterRessources *ir, instructionList *result) {
+    if(first == NULL) {
+        appendInstruction(result, opLoad, numberOperand(addressImmediate, 0));
+    } else if(getExpressionType(first) == computedValue) {
+        getExpression(first, ir, result);
+    } else {
+        appendInstruction(result, opLoad, getExpressionCall(first, ir));
     }
-    return createStr();
 }
 
-char *loadSecondOperand(char *prev, parseToken *tok, interpreterRessources *ir) {
-    expressionType type = getExpressionType(tok, ir);
-    char *result;
+// Loads the first operand followed by the operation with the second one. The first operand is
+// generated after the second one is pushed, so its addresses relative to SP are right.
+void loadSecondOperand(parseToken *first, opcode operation, parseToken *tok,
+        interpreterRessources *ir, instructionList *result) {
+    expressionType type = getExpressionType(tok);
     if(type == computedValue) {
-        char *spStr;
-        char *loader;
+        addressing mode;
         if(canBeOnSP(tok)) {
-            loader = getOnSP(tok, ir);
-            spStr = catStrs(createStr(), "@");
+            getOnSP(tok, ir, result);
+            mode = addressIndirect;
         } else {
-            loader = catStrs(getExpression(tok, ir), "\tPUSH\n");
+            getExpression(tok, ir, result);
+            appendInstruction(result, opPush, noOperand);
             registerPUSH(ir);
-            spStr = createStr();
+            mode = addressAbsolute;
         }
-        
-        spStr = catStrs(spStr, "0(SP)\n");
 
-        result = catStrs(loader, prev);
-        free(prev);
-        result = catStrs(result, spStr);
-        free(spStr);
-        result = catStrs(result, "\tREL\t\t$1\n");
+        loadFirstOperand(first, ir, result);
+        appendInstruction(result, operation, stackOperand(mode, 0));
+        appendInstruction(result, opRel, numberOperand(addressImmediate, 1));
         registerPULL(ir);
     } else {
-        char *expressionCall = getExpressionCall(tok, ir);
-        result = catStrs(prev, expressionCall);
-        free(expressionCall);
-        result = catStrs(result, "\n");
+        loadFirstOperand(first, ir, result);
+        appendInstruction(result, operation, getExpressionCall(tok, ir));
     }
-
-    return result;
 }
 
 parseToken *getWithoutNegation(parseToken *tok) {
     if(tok->type == negation) {
-        tok->nNodes = 0;
         return tok->subNodes[0];
     }
     if(tok->type == expression && tok->nNodes == 1) {
@@ -1500,122 +1703,90 @@ parseToken *getWithoutNegation(parseToken *tok) {
     return NULL;
 }
 
-char *getBinaryExpression(parseToken *tok, interpreterRessources *ir) {
+void getBinaryExpression(parseToken *tok, interpreterRessources *ir, instructionList *result) {
     parseToken *left = tok->subNodes[0];
     parseToken *right = tok->subNodes[1];
     int opCode = tok->values[0].value;
-    expressionType leftType = getExpressionType(left, ir);
-    expressionType rightType = getExpressionType(right, ir);
-    
-    char *result;
-
-    if(leftType == computedValue) {
-        result = getExpression(left, ir);
-    } else {
-        result = catStrs(createStr(), "\tLOAD\t");
-        char *expressionCall = getExpressionCall(left, ir);
-        result = catStrs(result, expressionCall);
-        free(expressionCall);
-        result = catStrs(result, "\n");
-    }
     
     if(opCode == 0 || opCode == 1) {
         parseToken *newRight = getWithoutNegation(right);
         if(newRight != NULL) {
             tok->values[0].value = 1 - opCode;
             tok->subNodes[1] = newRight;
-            freeToken(right);
-            free(result);
-            return getBinaryExpression(tok, ir);
+            getBinaryExpression(tok, ir, result);
+            return;
         }
     }
 
-    char *operator = catStrs(createStr(), "\t");
+    expressionType leftType = getExpressionType(left);
+    expressionType rightType = getExpressionType(right);
+
+    opcode operator;
 
     switch(opCode) {
         case 1:
-            operator = catStrs(operator, "SUB");
+            operator = opSub;
             break;
         case 2:
-            operator = catStrs(operator, "MUL");
+            operator = opMul;
             break;
         case 3:
-            operator = catStrs(operator, "DIV");
+            operator = opDiv;
             break;
         case 4:
-            operator = catStrs(operator, "MOD");
+            operator = opMod;
             break;
         default:
-            operator = catStrs(operator, "ADD");
+            operator = opAdd;
     }
 
-    operator = catStrs(operator, "\t\t");
-
     if(leftType != computedValue && rightType == computedValue && !canBeOnSP(right) && isCommutative(tok)) {
-        free(result);
-        result = getExpression(right, ir);
-        result = catStrs(result, operator);
-        char *expressionCall = getExpressionCall(left, ir);
-        result = catStrs(result, expressionCall);
-        free(expressionCall);
-        result = catStrs(result, "\n");
-        return result;
+        getExpression(right, ir, result);
+        appendInstruction(result, operator, getExpressionCall(left, ir));
+        return;
     }
     
-    result = catStrs(result, operator);
-    
-    free(operator);
-
-    result = loadSecondOperand(result, right, ir);
-
-    return result;
+    loadSecondOperand(left, operator, right, ir, result);
 }
 
-char *getExpression(parseToken *tok, interpreterRessources *ir) {
-    expressionType typeEx = getExpressionType(tok, ir);
+void getExpression(parseToken *tok, interpreterRessources *ir, instructionList *result) {
+    expressionType typeEx = getExpressionType(tok);
 
     if(typeEx == exprFailure) {
-        return createStr();
+        return;
     }
 
     if(typeEx == literalValue || typeEx == singleValueVar) {
-        char *result = catStrs(createStr(), "\tLOAD\t");
-        char *expression = getExpressionCall(tok, ir);
-        result = catStrs(result, expression);
-        free(expression);
-        result = catStrs(result, "\n");
-        return result;
+        appendInstruction(result, opLoad, getExpressionCall(tok, ir));
+        return;
     }
 
     if(tok->nNodes == 1 && tok->type == expression) {
-        return getExpression(tok->subNodes[0], ir);
+        getExpression(tok->subNodes[0], ir, result);
+        return;
     }
 
     if(tok->nNodes == 2) {
-        return getBinaryExpression(tok, ir);
+        getBinaryExpression(tok, ir, result);
+        return;
     }
 
     if(tok->type == negation) {
-        char *result = catStrs(createStr(), "\tLOAD\t$0\n\tSUB\t");
-
-        result = loadSecondOperand(result, tok->subNodes[0], ir);
-        return result;
+        loadSecondOperand(NULL, opSub, tok->subNodes[0], ir, result);
+        return;
     }
 
     if(tok->type == value) {
         parseToken *call = tok->subNodes[0];
         if(call->type == arrayCall) {
-            char *result = varAddressInSP(call, ir);
-            result = catStrs(result, "\tLOAD\t@0(SP)\n");
-            result = catStrs(result, "\tREL\t\t$1\n");
+            varAddressInSP(call, ir, result);
+            appendInstruction(result, opLoad, stackOperand(addressIndirect, 0));
+            appendInstruction(result, opRel, numberOperand(addressImmediate, 1));
             registerPULL(ir);
-            return result;
         } else if(call->type == procedureCall) {
-            return getProcedureCall(call, ir, 1);
+            getProcedureCall(call, ir, 1, result);
         }
     }
-
-    return createStr();
 }
 
 int switchCondition(int opCode) {
@@ -1633,162 +1804,101 @@ int switchCondition(int opCode) {
     }
 }
 
-char *getConditionInternal(parseToken *left, int opCode, parseToken *right, interpreterRessources *ir,
-        int jumpIfTrue){
-    expressionType leftType = getExpressionType(left, ir);
-
-    char *result;
-
-    if(leftType == computedValue) {
-        result = getExpression(left, ir);
-    } else {
-        result = catStrs(createStr(), "\tLOAD\t");
-        char *expressionCall = getExpressionCall(left, ir);
-        result = catStrs(result, expressionCall);
-        free(expressionCall);
-        result = catStrs(result, "\n");
-    }
-
-    result = catStrs(result, "\tCMP\t\t");
-
-    result = loadSecondOperand(result, right, ir);
+void getConditionInternal(parseToken *left, int opCode, parseToken *right, interpreterRessources *ir,
+        int jumpIfTrue, int dest, instructionList *result){
+    loadSecondOperand(left, opCmp, right, ir, result);
     
-    char *operator = catStrs(createStr(), "\t");
-    char *operatorTrue = createStr();
-    char *operatorFalse = createStr();
+    opcode operatorTrue;
+    opcode operatorFalse;
 
     switch(opCode) {
         case 1:
-            operatorTrue = catStrs(operatorTrue, "JMPNZ");
-            operatorFalse = catStrs(operatorFalse, "JMPZ");
+            operatorTrue = opJmpnz;
+            operatorFalse = opJmpz;
             break;
         case 2:
-            operatorTrue = catStrs(operatorTrue, "JMPN");
-            operatorFalse = catStrs(operatorFalse, "JMPNN");
+            operatorTrue = opJmpn;
+            operatorFalse = opJmpnn;
             break;
         case 3:
-            operatorTrue = catStrs(operatorTrue, "JMPP");
-            operatorFalse = catStrs(operatorFalse, "JMPNP");
+            operatorTrue = opJmpp;
+            operatorFalse = opJmpnp;
             break;
         case 4:
-            operatorTrue = catStrs(operatorTrue, "JMPNP");
-            operatorFalse = catStrs(operatorFalse, "JMPP");
+            operatorTrue = opJmpnp;
+            operatorFalse = opJmpp;
             break;
         case 5:
-            operatorTrue = catStrs(operatorTrue, "JMPNN");
-            operatorFalse = catStrs(operatorFalse, "JMPN");
+            operatorTrue = opJmpnn;
+            operatorFalse = opJmpn;
             break;
         default:
-            operatorTrue = catStrs(operatorTrue, "JMPZ");
-            operatorFalse = catStrs(operatorFalse, "JMPNZ");
-    }
-    
-    if(jumpIfTrue) {
-        operator = catStrs(operator, operatorTrue);
-    } else {
-        operator = catStrs(operator, operatorFalse);
+            operatorTrue = opJmpz;
+            operatorFalse = opJmpnz;
     }
 
-    free(operatorTrue);
-    free(operatorFalse);
-
-    operator = catStrs(operator, "\t");
-
-    result = catStrs(result, operator);
-    free(operator);
-
-    return result;
+    appendInstruction(result, jumpIfTrue ? operatorTrue : operatorFalse, markerOperand(dest));
 }
 
-char *getCondition(parseToken *tok, char *dest, interpreterRessources *ir, int jumpIfTrue) {
+void getCondition(parseToken *tok, int dest, interpreterRessources *ir, int jumpIfTrue, instructionList *result) {
     if(tok->type != condition) {
         ir->returnVal = 1;
-        fprintf(stderr, "The token is not a condition, but a %s!\n",
+        fprintf(ir->errors, "The token is not a condition, but a %s!\n",
                 stringFromParseType(tok->type));
-        return createStr();
+        return;
     }
 
     parseToken *left = tok->subNodes[0];
     parseToken *right = tok->subNodes[1];
     int opCode = tok->values[0].value;
 
-    expressionType leftType = getExpressionType(left, ir);
-    expressionType rightType = getExpressionType(right, ir);
+    expressionType leftType = getExpressionType(left);
+    expressionType rightType = getExpressionType(right);
     
     if(leftType == exprFailure || rightType == exprFailure) {
-        return createStr();
+        return;
+    }
+    
+    // Only the loops are left with a constant condition, they jump always or never
+    int constant = ir->optimize ? getConstantCondition(tok) : -1;
+    if(constant >= 0) {
+        if(constant == jumpIfTrue) {
+            appendInstruction(result, opJmp, markerOperand(dest));
+        }
+        return;
     }
-
-    char *result;
 
     if(leftType != computedValue && rightType == computedValue && !canBeOnSP(right)) {
-        result = getConditionInternal(right, switchCondition(opCode), left, ir, jumpIfTrue);
+        getConditionInternal(right, switchCondition(opCode), left, ir, jumpIfTrue, dest, result);
     } else {
-        result = getConditionInternal(left, opCode, right, ir, jumpIfTrue);
+        getConditionInternal(left, opCode, right, ir, jumpIfTrue, dest, result);
     }
-
-    result = catStrs(result, dest);
-    result = catStrs(result, "\n");
-    
-    return result;
 }
 
-char *catStrs(char *target, const char *origin) {
-    unsigned long newSize = strlen(target) + strlen(origin) + 1;
-    char *tmp = (char *) realloc(target, newSize);
-    if(tmp != NULL) {
-        target = tmp;
-        strcat(target, origin);
+int markerIsFree(int name, interpreterRessources *ir) {
+    if(lookupSymbol(ir->markers, name) >= 0) {
+        ir->returnVal = 1;
+        fprintf(ir->errors, "The marker with the name \"%s\" does already exist!\n", getName(name, ir));
+        return 0;
+    }
+    if(lookupSymbol(ir->vars->index, name) >= 0) {
+        ir->returnVal = 1;
+        fprintf(ir->errors,
+            "The marker with the name \"%s\" does already exist in form of a variable!\n",
+            getName(name, ir));
+        return 0;
     }
-    return target;
-}
-
-char *createStr() {
-    char *result = (char *) malloc(1);
-    result[0] = '\0';
-    return result;
-}
-
-char *itostr(int val) {
-    int lengthVal = snprintf(NULL, 0, "%i", val);
-
-    char *result = malloc(lengthVal + 1);
-    snprintf(result, lengthVal + 1, "%i", val);
     
-    return result;
+    return 1;
 }
 
-int registerMarker(char *name, interpreterRessources *ir) {
-    for(int i = 0; i < ir->nMarkers; ++i) {
-        if(strcmp(ir->markers[i], name) == 0) {
-            ir->returnVal = 1;
-            fprintf(stderr, "The marker with the name \"%s\" does already exist!\n", name);
-            return 0;
-        }
-    }
-    varList *vars = ir->vars;
-    for(int i = 0; i < vars->nVars; ++i) {
-        if(strcmp(vars->vars[i], name) == 0) {
-            ir->returnVal = 1;
-            fprintf(stderr,
-                "The marker with the name \"%s\" does already exist in form of a variable!\n",
-                name);
-            return 0;
-        }
-    }
-    
-    int newNr = ++(ir->nMarkers);
-    char **tmp = realloc(ir->markers, newNr* sizeof(char *));
-    if(tmp != NULL) {
-        ir->markers = tmp;
-        ir->markers[newNr - 1] = transferStr(name);
-        return 1;
-    } else {
-        ir->returnVal = 1;
-        --(ir->nMarkers);
-        fprintf(stderr, "Too many markers!\n");
+int registerMarker(int name, interpreterRessources *ir) {
+    if(!markerIsFree(name, ir)) {
         return 0;
     }
+    
+    insertSymbol(ir->markers, name, (ir->nMarkers)++);
+    return 1;
 }
 
 void registerPUSH(interpreterRessources *ir) {
@@ -1815,7 +1925,7 @@ void registerPULLNr(interpreterRessources *ir, int nr) {
     }
 }
 
-int registerVar(char *name, int array, int reference, interpreterRessources *ir, functionDef *useFunction) {
+int registerVar(int name, int array, int reference, interpreterRessources *ir, functionDef *useFunction) {
     varList *vars;
     
     varList *additionalVars = getAdditionalVarList(ir, 1);
@@ -1827,39 +1937,40 @@ int registerVar(char *name, int array, int reference, interpreterRessources *ir,
     } else {
         vars = ir->vars;
         
-        for(int i = 0; i < ir->nMarkers; ++i) {
-            if(strcmp(ir->markers[i], name) == 0) {
-                ir->returnVal = 1;
-                fprintf(stderr,
-                    "There exists already a marker named \"%s\", which forbids variables with that name!\n",
-                    name);
-                return 0;
-            }
-        }
-    }
-    
-    for(int i = 0; i < vars->nVars; ++i) {
-        if(strcmp(vars->vars[i], name) == 0) {
+        if(lookupSymbol(ir->markers, name) >= 0) {
             ir->returnVal = 1;
-            fprintf(stderr,
-                "The variable with the name \"%s\" does already exist!\n",
-                name);
+            fprintf(ir->errors,
+                "There exists already a marker named \"%s\", which forbids variables with that name!\n",
+                getName(name, ir));
             return 0;
         }
     }
+    
+    if(lookupSymbol(vars->index, name) >= 0) {
+        ir->returnVal = 1;
+        fprintf(ir->errors,
+            "The variable with the name \"%s\" does already exist!\n",
+            getName(name, ir));
+        return 0;
+    }
 
     
     int newNr = ++(vars->nVars);
-    char **tmp_1 = realloc(vars->vars, newNr * sizeof(char *));
+    int *tmp_1 = realloc(vars->vars, newNr * sizeof(int));
     int *tmp_2 = realloc(vars->varIsArray, newNr* sizeof(int));
     int *tmp_3 = realloc(vars->varIsReference, newNr* sizeof(int));
-    if(tmp_1 != NULL && tmp_2 != NULL && tmp_3 != NULL) {
+    int *tmp_4 = realloc(vars->positions, newNr* sizeof(int));
+    if(tmp_1 != NULL && tmp_2 != NULL && tmp_3 != NULL && tmp_4 != NULL) {
         vars->vars = tmp_1;
         vars->varIsArray = tmp_2;
         vars->varIsReference = tmp_3;
-        vars->vars[newNr - 1] = transferStr(name);
+        vars->positions = tmp_4;
+        vars->vars[newNr - 1] = name;
         vars->varIsArray[newNr - 1] = array;
         vars->varIsReference[newNr - 1] = reference;
+        vars->positions[newNr - 1] = vars->totalSize;
+        vars->totalSize += getVarSize(vars, newNr - 1);
+        insertSymbol(vars->index, name, newNr - 1);
         return 1;
     } else {
         if(tmp_1 != NULL) {
@@ -1871,51 +1982,52 @@ int registerVar(char *name, int array, int reference, interpreterRessources *ir,
         if(tmp_3 != NULL) {
             vars->varIsReference = tmp_3;
         }
+        if(tmp_4 != NULL) {
+            vars->positions = tmp_4;
+        }
         --(vars->nVars);
         ir->returnVal = 1;
-        fprintf(stderr, "Too many vars!\n");
+        fprintf(ir->errors, "Too many vars!\n");
         return 0;
     }
 }
 
-char *getNumberedMarker(interpreterRessources *ir) {
+int getNumberedMarker(interpreterRessources *ir) {
     int nr = ++(ir->nGenericMarkers);
 
-    char *result = catStrs(createStr(), "m$");
+    char marker[16];
+    int length = snprintf(marker, sizeof(marker), "m$%i", nr);
 
-    char *nrStr = itostr(nr);
+    // Only looked up, as procedures are generated concurrently and mustn't change the interner.
+    // The numbers are unique, so only names from the source can collide with them.
+    int name = findName(ir->symbols, marker, length);
 
-    result = catStrs(result, nrStr);
-    free(nrStr);
-
-    if(registerMarker(result, ir)) {
-        return result;
+    if(name >= 0 && !markerIsFree(name, ir)) {
+        return -1;
     }
 
-    free(result);
-
-    return NULL;
+    return nr;
 }
 
-varCallType resolveVarCall(parseToken *tok, interpreterRessources *ir) {
+varCallType findVarCall(parseToken *tok, interpreterRessources *ir) {
     int array;
     int index = -1;
     if(tok->type == varCall) {
         array = 0;
     } else if(tok->type == arrayCall) {
         array = 1;
-        if(getExpressionType(tok->subNodes[0], ir) == literalValue) {
-            index = getLiteralExpressionValue(tok->subNodes[0], ir);
+        if(annotateExpression(tok->subNodes[0], ir) == literalValue) {
+            index = getLiteralExpressionValue(tok->subNodes[0]);
         }
     } else {
         ir->returnVal = 1;
-        fprintf(stderr, "The token is not a var- or arrayCall, but a %s!\n",
+        fprintf(ir->errors, "The token is not a var- or arrayCall, but a %s!\n",
                 stringFromParseType(tok->type));
         return 0;
     }
 
 
-    char *name = tok->values[0].name;
+    int name = tok->values[0].name;
     
     varList *vars;
     
@@ -1927,57 +2039,72 @@ varCallType resolveVarCall(parseToken *tok, interpreterRessources *ir) {
     
     if (additionalVars != NULL) {
         vars = additionalVars;
-        for(int i = 0; i < vars->nVars; ++i) {
-            char *var = vars->vars[i];
+        int i = lookupSymbol(vars->index, name);
+        if(i >= 0) {
             int varArray = vars->varIsArray[i];
-            if(strcmp(var, name) == 0) {
-                if(array == 1 && varArray == 0) {
-                    ir->returnVal = 1;
-                    fprintf(stderr, "Tried to access the variable \"%s\" as an array!\n", name);
-                    return callFailure;
-                } else if(array == 0 && varArray == 0) {
+            tok->symbol = i;
+            tok->arraySize = varArray;
+            if(array == 1 && varArray == 0) {
+                ir->returnVal = 1;
+                fprintf(ir->errors, "Tried to access the variable \"%s\" as an array!\n", getName(name, ir));
+                return callFailure;
+            } else if(array == 0 && varArray == 0) {
+                return singleValueLocal;
+            } else if(array == 1 && varArray > 0) {
+                if(index == 0) {
                     return singleValueLocal;
-                } else if(array == 1 && varArray > 0) {
-                    if(index == 0) {
-                        return singleValueLocal;
-                    } else {
-                        return valueInArrayLocal;
-                    }
-                } else if(array == 0 && varArray > 0) {
-                    return wholeArrayLocal;
+                } else {
+                    return valueInArrayLocal;
                 }
+            } else if(array == 0 && varArray > 0) {
+                return wholeArrayLocal;
             }
         }
     }
     
     vars = ir->vars;
     
-    for(int i = 0; i < vars->nVars; ++i) {
-        char *var = vars->vars[i];
+    int i = lookupSymbol(vars->index, name);
+    if(i >= 0) {
         int varArray = vars->varIsArray[i];
-        if(strcmp(var, name) == 0) {
-            if(array == 1 && varArray == 0) {
-                ir->returnVal = 1;
-                fprintf(stderr, "Tried to access the variable \"%s\" as an array!\n", name);
-                return callFailure;
-            } else if(array == 0 && varArray == 0) {
+        tok->symbol = i;
+        tok->arraySize = varArray;
+        if(array == 1 && varArray == 0) {
+            ir->returnVal = 1;
+            fprintf(ir->errors, "Tried to access the variable \"%s\" as an array!\n", getName(name, ir));
+            return callFailure;
+        } else if(array == 0 && varArray == 0) {
+            return singleValue;
+        } else if(array == 1 && varArray > 0) {
+            if(index == 0) {
                 return singleValue;
-            } else if(array == 1 && varArray > 0) {
-                if(index == 0) {
-                    return singleValue;
-                } else {
-                    return valueInArray;
-                }
-            } else if(array == 0 && varArray > 0) {
-                return wholeArray;
+            } else {
+                return valueInArray;
             }
+        } else if(array == 0 && varArray > 0) {
+            return wholeArray;
         }
     }
     ir->returnVal = 1;
-    fprintf(stderr, "Tried to access the non-existing variable \"%s\"!\n", name);
+    fprintf(ir->errors, "Tried to access the non-existing variable \"%s\"!\n", getName(name, ir));
     return callFailure;
 }
 
+// Resolves the variable once and stores the result in the token for the code generation
+varCallType annotateVarCall(parseToken *tok, interpreterRessources *ir) {
+    if(!tok->annotated) {
+        tok->annotated = 1;
+        tok->symbol = -1;
+        tok->callType = findVarCall(tok, ir);
+    }
+    
+    return tok->callType;
+}
+
+varCallType resolveVarCall(parseToken *tok) {
+    return tok->callType;
+}
+
 varCallType collapseVCType(varCallType type) {
     if(type > 3) {
         return type - 3;
@@ -1986,54 +2113,37 @@ varCallType collapseVCType(varCallType type) {
     return type;
 }
 
-int varCallIsLocal(parseToken *tok, interpreterRessources *ir) {
-    varCallType type = resolveVarCall(tok, ir);
+int varCallIsLocal(parseToken *tok) {
+    varCallType type = resolveVarCall(tok);
     if(type > 3) {
         return 1;
     }
     return 0;
 }
 
-char *getLocalVarCall(parseToken *tok, interpreterRessources *ir) {
+operand getLocalVarCall(parseToken *tok, interpreterRessources *ir, addressing mode) {
     internalFunctionVals *func = ir->currentFunction;
     if(func == NULL) {
-        return createStr();
+        return stackOperand(mode, 0);
     }
     
-    int remaining = func->sizeVarsOnStack;
-    int offset = 0;
-    int finalOffset = 0;
     varList *list = func->internalVars;
-    char *name = tok->values[0].name;
+    int remaining = func->sizeVarsOnStack - list->totalSize;
+    int finalOffset = 0;
     
-    for(int i = list->nVars - 1; i >= 0; --i) {
-        if(strcmp(list->vars[i], name) != 0) {
-            offset += list->varIsArray[i];
-            
-            if(list->varIsArray[i] < 1) {
-                ++offset;
-            }
-        } else {
-            finalOffset = offset;
-            
-            if(i >= func->nParams) {
-                --finalOffset;
-            }
-        }
-        
-        remaining -= list->varIsArray[i];
+    int i = tok->symbol;
+    
+    if(i >= 0) {
+        finalOffset = list->totalSize - list->positions[i] - getVarSize(list, i);
         
-        if(list->varIsArray[i] < 1) {
-            --remaining;
+        if(i >= func->nParams) {
+            --finalOffset;
         }
     }
     
     finalOffset += remaining;
     
-    char *result = catStrs(createStr(), itostr(finalOffset));
-    result = catStrs(result, "(SP)");
-    
-    return result;
+    return stackOperand(mode, finalOffset);
 }
 
 expressionType varCallToExpressionType(varCallType type) {
@@ -2061,21 +2171,21 @@ expressionType combineExpressionTypes(expressionType leftType, expressionType ri
     return computedValue;
 }
 
-expressionType getExpressionType(parseToken *tok, interpreterRessources *ir) {
+expressionType findExpressionType(parseToken *tok, interpreterRessources *ir) {
     if(tok->type != expression && tok->type != negation && tok->type != value) {
         ir->returnVal = 1;
-        fprintf(stderr, "The token is not an expression, negation or value, but a %s!\n",
+        fprintf(ir->errors, "The token is not an expression, negation or value, but a %s!\n",
                 stringFromParseType(tok->type));
         return exprFailure;
     }
     
     if(tok->type == expression && tok->nNodes == 1) {
-        return getExpressionType(tok->subNodes[0], ir);
+        return annotateExpression(tok->subNodes[0], ir);
     } else if(tok->type == negation) {
-        expressionType type = getExpressionType(tok->subNodes[0], ir);
+        expressionType type = annotateExpression(tok->subNodes[0], ir);
         if(type == array) {
             ir->returnVal = 1;
-            fprintf(stderr, "A whole array can't be negated!\n");
+            fprintf(ir->errors, "A whole array can't be negated!\n");
             return exprFailure;
         }
         if(type == singleValueVar) {
@@ -2083,104 +2193,95 @@ expressionType getExpressionType(parseToken *tok, interpreterRessources *ir) {
         }
         return type;
     } else if (tok->type == expression && tok->nNodes == 2) {
-        expressionType leftType = getExpressionType(tok->subNodes[0], ir);
-        expressionType rightType = getExpressionType(tok->subNodes[1], ir);
+        expressionType leftType = annotateExpression(tok->subNodes[0], ir);
+        expressionType rightType = annotateExpression(tok->subNodes[1], ir);
         if(leftType == array || rightType == array) {
             ir->returnVal = 1;
-            fprintf(stderr, "A whole array can't be used in a operation!\n");
+            fprintf(ir->errors, "A whole array can't be used in a operation!\n");
+            return exprFailure;
+        }
+        
+        // Constants are computed by the compiler, which can't divide by zero
+        expressionType type = combineExpressionTypes(leftType, rightType);
+        int operator = tok->values[0].value;
+        if(type == literalValue && (operator == 3 || operator == 4)
+                && getRecursiveExpressionValue(tok->subNodes[1]) == 0) {
+            ir->returnVal = 1;
+            fprintf(ir->errors, "A constant can't be divided by zero!\n");
             return exprFailure;
         }
-        return combineExpressionTypes(leftType, rightType);
+        return type;
 
     } else {
         if(tok->nVal == 1) {
             return literalValue;
         }
         if(tok->subNodes[0]->type == procedureCall) {
+            annotateTree(tok->subNodes[0], ir);
             return computedValue;
         }
-        varCallType type = resolveVarCall(tok->subNodes[0], ir);
+        varCallType type = annotateVarCall(tok->subNodes[0], ir);
         return varCallToExpressionType(type);
     }
 }
 
-int getRecursiveExpressionValue(parseToken *tok) {
+expressionType annotateExpression(parseToken *tok, interpreterRessources *ir) {
+    if(!tok->annotated) {
+        tok->annotated = 1;
+        tok->exprType = findExpressionType(tok, ir);
+    }
+    
+    return tok->exprType;
+}
+
+expressionType getExpressionType(parseToken *tok) {
+    return tok->exprType;
+}
+
+// Annotates every expression and variable access below the token, has to run before its code is generated
+void annotateTree(parseToken *tok, interpreterRessources *ir) {
     switch(tok->type) {
+        case expression:
         case negation:
-            return -1 * getRecursiveExpressionValue(tok->subNodes[0]);
         case value:
-            return tok->values[0].value;
+            annotateExpression(tok, ir);
+            return;
+        case varCall:
+        case arrayCall:
+            annotateVarCall(tok, ir);
+            return;
         default:
-            if(tok->nNodes == 2) {
-                parseToken *leftSide = tok->subNodes[0];
-                parseToken *rightSide = tok->subNodes[1];
-                int leftValue = getRecursiveExpressionValue(leftSide);
-                int rightValue = getRecursiveExpressionValue(rightSide);
-                int operator = tok->values[0].value;
-                switch(operator) {
-                    case 1:
-                        return leftValue - rightValue;
-                    case 2:
-                        return leftValue * rightValue;
-                    case 3:
-                        return leftValue / rightValue;
-                    case 4:
-                        return leftValue % rightValue;
-                    default:
-                        return leftValue + rightValue;
-                }
-            } else {
-                return getRecursiveExpressionValue(tok->subNodes[0]);
+            for(int i = 0; i < tok->nNodes; ++i) {
+                annotateTree(tok->subNodes[i], ir);
             }
     }
 }
 
-int getLiteralExpressionValue(parseToken *tok, interpreterRessources *ir) {
-    if(getExpressionType(tok, ir) == literalValue) {
+int getLiteralExpressionValue(parseToken *tok) {
+    if(getExpressionType(tok) == literalValue) {
         return getRecursiveExpressionValue(tok);
     }
     return 0;
 }
 
-char *getRecursiveExpressionCall(parseToken *tok, interpreterRessources *ir) {
+operand getRecursiveExpressionCall(parseToken *tok, interpreterRessources *ir) {
     if(tok->type == expression || tok->type == value) {
         return getRecursiveExpressionCall(tok->subNodes[0], ir);
     }
-    if(tok->type == varCall) {
-        if(varCallIsLocal(tok, ir)) {
-            return getLocalVarCall(tok, ir);
-        }
-        return catStrs(createStr(), tok->values[0].name);
-    }
-    if(tok->type == arrayCall && tok->values[1].value == 0) {
-        if(varCallIsLocal(tok, ir)) {
-            return getLocalVarCall(tok, ir);
-        }
-        return catStrs(createStr(), tok->values[0].name);
+    if(tok->type == varCall || tok->type == arrayCall) {
+        return getVarName(tok, ir, addressAbsolute);
     }
-    return createStr();
+    return noOperand;
 }
 
-char *getExpressionCall(parseToken *tok, interpreterRessources *ir) {
-    expressionType type = getExpressionType(tok, ir);
-
-    if(type == exprFailure) {
-        return createStr();
-    }
+// The operand of a literal or a single variable, which needs no code to be computed
+operand getExpressionCall(parseToken *tok, interpreterRessources *ir) {
+    expressionType type = getExpressionType(tok);
 
     if(type == literalValue) {
-        int nr = getLiteralExpressionValue(tok, ir);
-        
-        char *nrStr = itostr(nr);
-        
-        char *result = catStrs(createStr(), "$");
-        result = catStrs(result, nrStr);
-        free(nrStr);
-
-        return result;
+        return numberOperand(addressImmediate, getLiteralExpressionValue(tok));
     } else if(type == singleValueVar) {
         return getRecursiveExpressionCall(tok, ir);
     }
-    return createStr();
+    return noOperand;
 }
-
@@ -2,7 +2,14 @@
 #define INTERPRETER_H
 
 #include "parsetree.h"
+#include "interner.h"
+#include "threadpool.h"
+#include "procedurecache.h"
+#include "phasetimer.h"
+#include <stdio.h>
 
-char *createAssembly(parseToken *programToken, int *returnVal);
+void createAssembly(parseToken *programToken, arena *tokens, interner *symbols, threadPool *pool,
+        procedureCache *cache, phaseTimer *timer, int optimize, int verbose, FILE *output,
+        FILE *errors, int *returnVal);
 
 #endif //INTERPRETER_H
@@ -0,0 +1,294 @@
+#include "lexer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+typedef struct keyword keyword;
+
+struct keyword {
+    const char *name;
+    size_t length;
+    int token;
+};
+
+// Indexed by the sum of the first and the last letter in lower case, modulo 32, which is
+// different for every keyword
+static const keyword keywords[32] = {
+    [0] = {"return", 6, _RETURN},
+    [1] = {"until", 5, _UNTIL},
+    [2] = {"then", 4, _THEN},
+    [3] = {"to", 2, _TO},
+    [6] = {"repeat", 6, _REPEAT},
+    [8] = {"var", 3, _VAR},
+    [9] = {"end", 3, _END},
+    [10] = {"else", 4, _ELSE},
+    [15] = {"if", 2, _IF},
+    [16] = {"begin", 5, _BEGIN},
+    [19] = {"do", 2, _DO},
+    [20] = {"function", 8, _FUNCTION},
+    [21] = {"procedure", 9, _PROCEDURE},
+    [24] = {"for", 3, _FOR},
+    [27] = {"by", 2, _BY},
+    [28] = {"while", 5, _WHILE},
+    [29] = {"program", 7, _PROGRAM},
+};
+
+void initScanner(scanner *sc, sourceBuffer *source, parseContext *context) {
+    sc->position = source->text;
+    sc->end = source->text + source->length;
+    sc->token = source->text;
+    sc->tokenLength = 0;
+    sc->line = 1;
+    sc->context = context;
+    sc->scanned = NULL;
+    sc->nScanned = 0;
+    sc->nextScanned = 0;
+}
+
+int scanToken(YYSTYPE *yylval, scanner *sc);
+
+// Scans the whole source, so the time of scanning can be measured apart from parsing
+int scanAllTokens(scanner *sc) {
+    size_t capacity = 0;
+    
+    while(1) {
+        if(sc->nScanned == capacity) {
+            capacity = capacity * 2 + 1024;
+            scannedToken *tmp = (scannedToken *) realloc(sc->scanned, capacity * sizeof(scannedToken));
+            if(tmp == NULL) {
+                return 1;
+            }
+            sc->scanned = tmp;
+        }
+        
+        scannedToken *next = &sc->scanned[sc->nScanned++];
+        next->token = scanToken(&next->value, sc);
+        next->text = sc->token;
+        next->length = sc->tokenLength;
+        next->line = sc->line;
+        
+        if(next->token == 0) {
+            return 0;
+        }
+    }
+}
+
+void freeScanner(scanner *sc) {
+    free(sc->scanned);
+    sc->scanned = NULL;
+    sc->nScanned = 0;
+}
+
+static int isIdentifierChar(unsigned char c) {
+    return ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') || (c >= '0' && c <= '9') || c == '$' || c == '_';
+}
+
+#ifdef __SSE2__
+
+// A bit for every byte of the chunk that is in [low, high]
+static unsigned int rangeMask(__m128i chunk, char low, char high) {
+    __m128i offset = _mm_sub_epi8(chunk, _mm_set1_epi8(low));
+    __m128i outside = _mm_subs_epu8(offset, _mm_set1_epi8((char) (high - low)));
+    return (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(outside, _mm_setzero_si128()));
+}
+
+static unsigned int byteMask(__m128i chunk, char c) {
+    return (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(c)));
+}
+
+static __m128i loadChunk(const char *p) {
+    return _mm_loadu_si128((const __m128i *) p);
+}
+
+#endif
+
+// Skips spaces, tabs and newlines and counts the newlines
+static const char *skipWhitespace(const char *p, const char *end, int *line) {
+#ifdef __SSE2__
+    while(p + 16 <= end) {
+        __m128i chunk = loadChunk(p);
+        unsigned int newlines = byteMask(chunk, '\n');
+        unsigned int other = ~(newlines | byteMask(chunk, ' ') | byteMask(chunk, '\t')) & 0xffff;
+        
+        if(other != 0) {
+            unsigned int skipped = (1u << __builtin_ctz(other)) - 1;
+            *line += __builtin_popcount(newlines & skipped);
+            return p + __builtin_ctz(other);
+        }
+        *line += __builtin_popcount(newlines);
+        p += 16;
+    }
+#endif
+    while(*p == ' ' || *p == '\t' || *p == '\n') {
+        *line += *p == '\n';
+        ++p;
+    }
+    return p;
+}
+
+static const char *skipIdentifier(const char *p, const char *end) {
+#ifdef __SSE2__
+    while(p + 16 <= end) {
+        __m128i chunk = loadChunk(p);
+        unsigned int letters = rangeMask(_mm_or_si128(chunk, _mm_set1_epi8(0x20)), 'a', 'z');
+        unsigned int other = ~(letters | rangeMask(chunk, '0', '9') | byteMask(chunk, '$')
+                | byteMask(chunk, '_')) & 0xffff;
+        
+        if(other != 0) {
+            return p + __builtin_ctz(other);
+        }
+        p += 16;
+    }
+#endif
+    while(isIdentifierChar((unsigned char) *p)) {
+        ++p;
+    }
+    return p;
+}
+
+static const char *skipDigits(const char *p, const char *end) {
+#ifdef __SSE2__
+    while(p + 16 <= end) {
+        unsigned int other = ~rangeMask(loadChunk(p), '0', '9') & 0xffff;
+        if(other != 0) {
+            return p + __builtin_ctz(other);
+        }
+        p += 16;
+    }
+#endif
+    while(*p >= '0' && *p <= '9') {
+        ++p;
+    }
+    return p;
+}
+
+// Returns the position after the "*)" that ends the comment, or the end of the text
+static const char *skipComment(const char *p, const char *end, int *line) {
+#ifdef __SSE2__
+    // The second load reaches one byte further, which is still in the padding
+    while(p + 16 <= end) {
+        __m128i chunk = loadChunk(p);
+        unsigned int newlines = byteMask(chunk, '\n');
+        unsigned int closing = byteMask(chunk, '*') & byteMask(loadChunk(p + 1), ')');
+        
+        if(closing != 0) {
+            unsigned int skipped = (1u << __builtin_ctz(closing)) - 1;
+            *line += __builtin_popcount(newlines & skipped);
+            return p + __builtin_ctz(closing) + 2;
+        }
+        *line += __builtin_popcount(newlines);
+        p += 16;
+    }
+#endif
+    while(p < end) {
+        if(p[0] == '*' && p[1] == ')') {
+            return p + 2;
+        }
+        *line += *p == '\n';
+        ++p;
+    }
+    return end;
+}
+
+// Returns the position after the newline that ends the comment, or the end of the text
+static const char *skipLineComment(const char *p, const char *end, int *line) {
+    const char *newline = (const char *) memchr(p, '\n', end - p);
+    if(newline == NULL) {
+        return end;
+    }
+    ++*line;
+    return newline + 1;
+}
+
+static int findKeyword(const char *text, size_t length) {
+    if(length < 2 || length > 9) {
+        return 0;
+    }
+    
+    const keyword *candidate = &keywords[((text[0] | 0x20) + (text[length - 1] | 0x20)) & 31];
+    if(candidate->length != length) {
+        return 0;
+    }
+    
+    // Folding the case keeps digits, and turns '$' and '_' into characters no keyword has
+    for(size_t i = 0; i < length; ++i) {
+        if((text[i] | 0x20) != candidate->name[i]) {
+            return 0;
+        }
+    }
+    return candidate->token;
+}
+
+// Comments and whitespace are skipped. Other bytes that are neither printable ASCII nor part of
+// a token are ignored.
+int scanToken(YYSTYPE *yylval, scanner *sc) {
+    const char *p = sc->position;
+    const char *end = sc->end;
+    
+    while(p < end) {
+        unsigned char c = (unsigned char) *p;
+        
+        if(c == ' ' || c == '\t' || c == '\n') {
+            p = skipWhitespace(p, end, &sc->line);
+        } else if(c == '(' && p[1] == '*') {
+            p = skipComment(p + 2, end, &sc->line);
+        } else if(c == '#') {
+            p = skipLineComment(p + 1, end, &sc->line);
+        } else if((c | 0x20) >= 'a' && (c | 0x20) <= 'z') {
+            const char *last = skipIdentifier(p + 1, end);
+            sc->token = p;
+            sc->tokenLength = last - p;
+            sc->position = last;
+            
+            int token = findKeyword(p, last - p);
+            if(token != 0) {
+                return token;
+            }
+            yylval->name = internName(sc->context->symbols, p, last - p);
+            return IDENTIFIER;
+        } else if(c >= '0' && c <= '9') {
+            const char *last = skipDigits(p + 1, end);
+            sc->token = p;
+            sc->tokenLength = last - p;
+            sc->position = last;
+            // Like atoi, the digits are followed by a character that ends the conversion
+            yylval->value = (int) strtol(p, NULL, 10);
+            return NUMBER;
+        } else if(c >= '!' && c <= '~') {
+            sc->token = p;
+            sc->tokenLength = 1;
+            sc->position = p + 1;
+            return c;
+        } else {
+            ++p;
+        }
+    }
+    
+    sc->token = end;
+    sc->tokenLength = 0;
+    sc->position = end;
+    return 0;
+}
+
+int yylex(YYSTYPE *yylval, void *argument) {
+    scanner *sc = (scanner *) argument;
+    if(sc->scanned == NULL) {
+        return scanToken(yylval, sc);
+    }
+    
+    // The last token is the end of the input, which is handed out as often as it is asked for
+    scannedToken *next = &sc->scanned[sc->nextScanned];
+    if(sc->nextScanned + 1 < sc->nScanned) {
+        ++sc->nextScanned;
+    }
+    
+    *yylval = next->value;
+    sc->token = next->text;
+    sc->tokenLength = next->length;
+    sc->line = next->line;
+    return next->token;
+}
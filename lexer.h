@@ -0,0 +1,44 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include "y.tab.h"
+#include "parsecontext.h"
+#include "sourcebuffer.h"
+
+typedef struct scannedToken scannedToken;
+
+struct scannedToken {
+    int token;
+    YYSTYPE value;
+    const char *text;
+    size_t length;
+    int line;
+};
+
+typedef struct scanner scanner;
+
+// Scans a source buffer in place. The padding after the text ends every run of characters,
+// so the scalar loops need no bounds checks.
+struct scanner {
+    const char *position;
+    const char *end;
+    // The start and length of the last token, for diagnostics
+    const char *token;
+    size_t tokenLength;
+    int line;
+    parseContext *context;
+    // If the tokens were scanned in advance, they are handed out from here
+    scannedToken *scanned;
+    size_t nScanned;
+    size_t nextScanned;
+};
+
+void initScanner(scanner *sc, sourceBuffer *source, parseContext *context);
+
+int scanAllTokens(scanner *sc);
+
+void freeScanner(scanner *sc);
+
+int yylex(YYSTYPE *yylval, void *sc);
+
+#endif //LEXER_H
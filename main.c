@@ -8,8 +8,19 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <time.h>
 #include "parsetree.h"
+#include "parsecontext.h"
 #include "interpreter.h"
+#include "threadpool.h"
+#include "compileserver.h"
+#include "diskcache.h"
+#include "tempfile.h"
+#include "astfile.h"
+#include "memstats.h"
+#include "main.h"
 
 void printTabs(int indent) {
     int i = indent;
@@ -19,14 +30,14 @@ void printTabs(int indent) {
     }
 }
 
-void printInfo(parseToken *programToken, int indent) {
+void printInfo(parseToken *programToken, interner *symbols, int indent) {
     printTabs(indent);
     printf("%s\n\n", stringFromParseType(programToken->type));
     for(int i = 0; i < programToken->nVal; ++i) {
 
         if(programToken->valueTypes[i] == string){
             printTabs(indent);
-            printf("%s\n",programToken->values[i].name);
+            printf("%s\n",symbolName(symbols, programToken->values[i].name));
         } else {
             printTabs(indent);
             printf("%i\n",programToken->values[i].value);
@@ -36,26 +47,660 @@ void printInfo(parseToken *programToken, int indent) {
         printf("\n");
     }
     for(int i = 0; i < programToken->nNodes; ++i) {
-        printInfo(programToken->subNodes[i], indent + 1);
+        printInfo(programToken->subNodes[i], symbols, indent + 1);
     }
     if(programToken->nNodes > 0) {
         printf("\n");
     }
 }
 
-int handle(parseToken *programToken, int success) {
+// Files that can't be replaced, like devices or pipes, are written directly
+FILE *openOutputDirectly(char *outputPath, char **targetPath, FILE *errors) {
+    FILE *output = fopen(outputPath, "w");
+    if(output == NULL) {
+        fprintf(errors, "The output file \"%s\" couldn't be opened!\n", outputPath);
+        return NULL;
+    }
+    
+    *targetPath = strdup(outputPath);
+    return output;
+}
+
+// Output files are written to a temporary file next to them first, which is only renamed
+// into place after a successful compilation. Only regular files can be replaced like this: a
+// symbolic link is followed to the file it points to, which is replaced instead of the link, and
+// everything else, like /dev/null, is written directly. The path that is written is handed out as
+// targetPath, it is NULL for stdout.
+FILE *openOutput(char *outputPath, char **tmpPath, char **targetPath, FILE *errors) {
+    *tmpPath = NULL;
+    *targetPath = NULL;
+    
+    if(outputPath == NULL) {
+        return stdout;
+    }
+    
+    struct stat info;
+    char *target = realpath(outputPath, NULL);
+    if(target == NULL) {
+        // A link to a file that doesn't exist yet creates it where the link points to
+        if(lstat(outputPath, &info) == 0) {
+            return openOutputDirectly(outputPath, targetPath, errors);
+        }
+        target = strdup(outputPath);
+    } else if(stat(target, &info) != 0 || !S_ISREG(info.st_mode)) {
+        free(target);
+        return openOutputDirectly(outputPath, targetPath, errors);
+    }
+    
+    char *path;
+    int fd = createTempFile(target, &path);
+    if(fd < 0) {
+        fprintf(errors, "The output file \"%s\" couldn't be created!\n", outputPath);
+        free(target);
+        return NULL;
+    }
+    
+    FILE *output = fdopen(fd, "w");
+    if(output == NULL) {
+        fprintf(errors, "The output file \"%s\" couldn't be created!\n", outputPath);
+        close(fd);
+        unlink(path);
+        free(path);
+        free(target);
+        return NULL;
+    }
+    
+    *tmpPath = path;
+    *targetPath = target;
+    return output;
+}
+
+int closeOutput(FILE *output, char *tmpPath, char *targetPath, int success, FILE *errors) {
+    if(targetPath == NULL) {
+        if(fflush(output) != 0) {
+            fprintf(errors, "The assembly couldn't be written to the output!\n");
+            return 1;
+        }
+        return success;
+    }
+    
+    if(fclose(output) != 0 && success == 0) {
+        fprintf(errors, "The assembly couldn't be written to \"%s\"!\n", targetPath);
+        success = 1;
+    }
+    
+    if(tmpPath != NULL) {
+        if(success == 0 && rename(tmpPath, targetPath) != 0) {
+            fprintf(errors, "The output file \"%s\" couldn't be replaced!\n", targetPath);
+            success = 1;
+        }
+        
+        if(success != 0) {
+            unlink(tmpPath);
+        }
+        free(tmpPath);
+    }
+    
+    free(targetPath);
+    return success;
+}
+
+// stdout can't be replaced after a failure like an output file, so the assembly for it is kept in
+// memory and only written once the compilation succeeded
+int writeToStdout(parseContext *context, threadPool *pool) {
+    char *assembly = NULL;
+    size_t assemblyLength = 0;
+    FILE *generated = open_memstream(&assembly, &assemblyLength);
+    if(generated == NULL) {
+        fprintf(context->errors, "Couldn't assign memory to compile the input!\n");
+        return 1;
+    }
+    
+    int success = 0;
+    createAssembly(context->programToken, context->tokens, context->symbols, pool,
+            NULL, context->timer, context->optimize, context->verbose, generated,
+            context->errors, &success);
+    fclose(generated);
+    
     if(success == 0) {
-        //printInfo(programToken, 0);
-        char *assembly = createAssembly(programToken, &success);
+        enterPhase(context->timer, phaseOutput);
+        fwrite(assembly, 1, assemblyLength, stdout);
+        success = closeOutput(stdout, NULL, NULL, success, context->errors);
+        leavePhase(context->timer);
+    }
+    
+    free(assembly);
+    return success;
+}
+
+int handle(parseContext *context, int success, char *outputPath, threadPool *pool) {
+    if(success == 0) {
+        //printInfo(context->programToken, context->symbols, 0);
+        if(outputPath == NULL) {
+            success = writeToStdout(context, pool);
+        } else {
+            char *tmpPath;
+            char *targetPath;
+            FILE *output = openOutput(outputPath, &tmpPath, &targetPath, context->errors);
+            
+            if(output == NULL) {
+                success = 1;
+            } else {
+                createAssembly(context->programToken, context->tokens, context->symbols, pool,
+                        NULL, context->timer, context->optimize, context->verbose, output,
+                        context->errors, &success);
+                enterPhase(context->timer, phaseOutput);
+                success = closeOutput(output, tmpPath, targetPath, success, context->errors);
+                leavePhase(context->timer);
+            }
+        }
+        
+        if(success == 0) {
+            fprintf(context->errors, "Successfully parsed!\n");
+        }
+    }
+    
+    return success;
+}
+
+// A parse tree written with -a is loaded instead of parsing the source
+int parseInput(sourceBuffer *source, parseContext *context) {
+    if(isAstFile(source->text, source->length)) {
+        enterPhase(context->timer, phaseParsing);
+        int success = loadAst(source->text, source->length, context);
+        leavePhase(context->timer);
+        return success;
+    }
+    return parseSource(source, context);
+}
+
+int saveAst(parseContext *context, char *astPath) {
+    char *tmpPath;
+    char *targetPath;
+    FILE *output = openOutput(astPath, &tmpPath, &targetPath, context->errors);
+    if(output == NULL) {
+        return 1;
+    }
+    
+    int success = writeAst(context->programToken, context->symbols, output);
+    if(success != 0) {
+        fprintf(context->errors, "The parse tree couldn't be written to \"%s\"!\n", astPath);
+    }
+    return closeOutput(output, tmpPath, targetPath, success, context->errors);
+}
+
+int writeCachedAssembly(FILE *cached, char *outputPath, FILE *errors) {
+    char *tmpPath;
+    char *targetPath;
+    FILE *output = openOutput(outputPath, &tmpPath, &targetPath, errors);
+    if(output == NULL) {
+        return 1;
+    }
+    
+    int success = 0;
+    char buffer[65536];
+    size_t count;
+    while((count = fread(buffer, 1, sizeof(buffer), cached)) > 0) {
+        if(fwrite(buffer, 1, count, output) != count) {
+            break;
+        }
+    }
+    if(ferror(cached)) {
+        fprintf(errors, "The cached assembly couldn't be read!\n");
+        success = 1;
+    }
+    
+    return closeOutput(output, tmpPath, targetPath, success, errors);
+}
+
+// The assembly of a source that was compiled before is copied from the cache, without parsing
+// it again. Otherwise the assembly is generated into memory, so it can be stored afterwards.
+int compileCached(sourceBuffer *source, parseContext *context, char *outputPath,
+        threadPool *pool, diskCache *cache) {
+    char key[65];
+    // Only the optimization changes the assembly, the thread count doesn't
+    getCacheKey(source->text, source->length, context->optimize ? "" : "-O 0", key);
+    
+    FILE *cached = openCachedAssembly(cache, key);
+    if(cached != NULL) {
+        enterPhase(context->timer, phaseOutput);
+        int success = writeCachedAssembly(cached, outputPath, context->errors);
+        fclose(cached);
+        leavePhase(context->timer);
+        
         if(success == 0) {
-            printf("%s", assembly);
-            fprintf(stderr, "Successfully parsed!\n");
+            fprintf(context->errors, "Successfully parsed!\n");
         }
+        return success;
+    }
+    
+    char *assembly = NULL;
+    size_t assemblyLength = 0;
+    FILE *generated = open_memstream(&assembly, &assemblyLength);
+    int success = 1;
+    
+    if(generated != NULL) {
+        success = parseInput(source, context);
+        if(success == 0) {
+            createAssembly(context->programToken, context->tokens, context->symbols, pool,
+                    NULL, context->timer, context->optimize, context->verbose, generated,
+                    context->errors, &success);
+        }
+    } else {
+        fprintf(context->errors, "Couldn't assign memory to compile the input!\n");
+    }
+    
+    if(generated != NULL) {
+        fclose(generated);
+    }
+    
+    if(success == 0) {
+        enterPhase(context->timer, phaseOutput);
+        char *tmpPath;
+        char *targetPath;
+        FILE *output = openOutput(outputPath, &tmpPath, &targetPath, context->errors);
+        
+        if(output == NULL) {
+            success = 1;
+        } else {
+            fwrite(assembly, 1, assemblyLength, output);
+            success = closeOutput(output, tmpPath, targetPath, success, context->errors);
+        }
+        leavePhase(context->timer);
+    }
+    
+    if(success == 0) {
+        storeCachedAssembly(cache, key, assembly, assemblyLength);
+        fprintf(context->errors, "Successfully parsed!\n");
+    }
+    
+    free(assembly);
+    return success;
+}
 
-        free(assembly);
+// Without a cache the assembly is streamed to an output file while it is generated. Writing the
+// parse tree needs the parse, so the cache isn't used then.
+int compileInput(sourceBuffer *source, parseContext *context, char *outputPath, char *astPath,
+        threadPool *pool, diskCache *cache) {
+    // The cached assembly doesn't come with the report of -v
+    if(cache != NULL && astPath == NULL && !context->verbose) {
+        return compileCached(source, context, outputPath, pool, cache);
+    }
+    
+    int success = parseInput(source, context);
+    if(success == 0 && astPath != NULL) {
+        success = saveAst(context, astPath);
+    }
+    return handle(context, success, outputPath, pool);
+}
+
+typedef struct batchJob batchJob;
+struct batchJob {
+    poolTask task;
+    char *inputPath;
+    char *outputPath;
+    threadPool *pool;
+    diskCache *cache;
+    phaseTimer *timer;
+    int optimize;
+    int result;
+    char *errors;
+    size_t errorsLength;
+};
+
+// The assembly of "name.mis" is written to "name.asm", other names just get ".asm" appended
+char *getOutputPath(char *inputPath) {
+    unsigned long length = strlen(inputPath);
+    if(length > 4 && strcmp(inputPath + length - 4, ".mis") == 0) {
+        length -= 4;
+    }
+    
+    char *path = malloc(length + 5);
+    memcpy(path, inputPath, length);
+    strcpy(path + length, ".asm");
+    return path;
+}
+
+void compileFile(void *argument) {
+    batchJob *job = (batchJob *) argument;
+    
+    FILE *errors = open_memstream(&job->errors, &job->errorsLength);
+    if(errors == NULL) {
+        errors = stderr;
+    }
+    
+    sourceBuffer source;
+    if(mapSourceFile(job->inputPath, &source) != 0) {
+        fprintf(errors, "The file \"%s\" couldn't be read!\n", job->inputPath);
+        job->result = 1;
+    } else {
+        parseContext *context = createParseContext(errors);
+        context->timer = job->timer;
+        context->optimize = job->optimize;
+        job->result = compileInput(&source, context, job->outputPath, NULL, job->pool,
+                job->cache);
+        freeParseContext(context);
+        freeSource(&source);
+    }
+    
+    if(errors != stderr) {
+        fclose(errors);
+    }
+}
+
+// Adds every non-empty line of the manifest to the inputs
+int readManifest(char *manifestPath, char ***inputs, int *nInputs) {
+    FILE *manifest = fopen(manifestPath, "r");
+    if(manifest == NULL) {
+        fprintf(stderr, "The manifest \"%s\" couldn't be read!\n", manifestPath);
+        return 1;
+    }
+    
+    char *line = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    while((length = getline(&line, &capacity, manifest)) >= 0) {
+        while(length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+            line[--length] = '\0';
+        }
+        if(length == 0) {
+            continue;
+        }
+        
+        char **tmp = realloc(*inputs, (*nInputs + 1) * sizeof(char *));
+        if(tmp == NULL) {
+            fprintf(stderr, "Couldn't assign memory to read the manifest!\n");
+            free(line);
+            fclose(manifest);
+            return 1;
+        }
+        *inputs = tmp;
+        (*inputs)[(*nInputs)++] = strdup(line);
+    }
+    
+    free(line);
+    fclose(manifest);
+    return 0;
+}
+
+// Compiles every input to its own output on the pool and prints the diagnostics of the failed
+// inputs in the given order, followed by a summary. With a timer, the phases of all inputs are
+// added to it.
+int compileBatch(char **inputs, int nInputs, threadPool *pool, diskCache *cache,
+        phaseTimer *timer, int optimize) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    batchJob *jobs = calloc(nInputs, sizeof(batchJob));
+    if(jobs == NULL && nInputs > 0) {
+        fprintf(stderr, "Couldn't assign memory for the batch!\n");
+        return 1;
+    }
+    
+    for(int i = 0; i < nInputs; ++i) {
+        jobs[i].inputPath = inputs[i];
+        jobs[i].outputPath = getOutputPath(inputs[i]);
+        jobs[i].pool = pool;
+        jobs[i].cache = cache;
+        jobs[i].optimize = optimize;
+        if(timer != NULL) {
+            jobs[i].timer = (phaseTimer *) malloc(sizeof(phaseTimer));
+            initPhaseTimer(jobs[i].timer);
+        }
+        submitTask(pool, &jobs[i].task, compileFile, &jobs[i]);
+    }
+    
+    int failed = 0;
+    for(int i = 0; i < nInputs; ++i) {
+        waitForTask(pool, &jobs[i].task);
+        
+        if(jobs[i].timer != NULL) {
+            mergePhaseTimes(timer, jobs[i].timer);
+            free(jobs[i].timer);
+        }
+        
+        if(jobs[i].result != 0) {
+            ++failed;
+            fprintf(stderr, "%s:\n", jobs[i].inputPath);
+            if(jobs[i].errors != NULL) {
+                fwrite(jobs[i].errors, 1, jobs[i].errorsLength, stderr);
+            }
+        }
+        
+        free(jobs[i].errors);
+        free(jobs[i].outputPath);
+    }
+    free(jobs);
+    
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    
+    fprintf(stderr, "Compiled %i files: %i succeeded, %i failed in %.3f s\n",
+            nInputs, nInputs - failed, failed, seconds);
+    
+    return failed > 0;
+}
+
+int runBatch(char **arguments, int nArguments, char *manifestPath, int nThreads,
+        diskCache *cache, phaseTimer *timer, int optimize) {
+    char **inputs = malloc((nArguments + 1) * sizeof(char *));
+    memcpy(inputs, arguments, nArguments * sizeof(char *));
+    int nInputs = nArguments;
+    int success = 1;
+    
+    if(manifestPath == NULL || readManifest(manifestPath, &inputs, &nInputs) == 0) {
+        threadPool *pool = createThreadPool(nThreads);
+        success = compileBatch(inputs, nInputs, pool, cache, timer, optimize);
+        freeThreadPool(pool);
+    }
+    
+    // Only the inputs from the manifest were copied
+    for(int i = nArguments; i < nInputs; ++i) {
+        free(inputs[i]);
+    }
+    free(inputs);
+    return success;
+}
+
+double secondsSince(struct timespec *start, clockid_t clock) {
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+void printUsage(FILE *output) {
+    fprintf(output, "Usage: compiler [input.mis] [-o output.asm] [-a input.ast] [-j threads] [-O level]\n"
+            "                [-v] [-C cache-directory] [-M megabytes]\n"
+            "                [--time-report[=json]] [--mem-report[=json]]\n"
+            "       compiler -b [-j threads] input1.mis input2.mis ...\n"
+            "       compiler -m manifest.txt [-j threads] [input.mis ...]\n"
+            "       compiler -s compiler.sock [-j threads]\n"
+            "       compiler -c compiler.sock [input.mis] [-o output.asm]\n");
+}
+
+// The options that are followed by a value
+int takesValue(char *option) {
+    static const char *options[] = {"-o", "-a", "-j", "-O", "-m", "-s", "-c", "-C", "-M"};
+    for(int i = 0; i < (int) (sizeof(options) / sizeof(options[0])); ++i) {
+        if(strcmp(option, options[i]) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    char *inputPath = NULL;
+    char *outputPath = NULL;
+    char *astPath = NULL;
+    int nThreads = defaultThreadCount();
+    int batch = 0;
+    char *manifestPath = NULL;
+    char *serverPath = NULL;
+    char *clientPath = NULL;
+    char *cachePath = NULL;
+    long long cacheSize = DEFAULT_CACHE_SIZE;
+    int timeReport = 0;
+    int jsonReport = 0;
+    int memReport = 0;
+    int jsonMemReport = 0;
+    int optimize = 1;
+    int verbose = 0;
+    char **inputs = malloc(argc * sizeof(char *));
+    int nInputs = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+            astPath = argv[++i];
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            nThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-O") == 0 && i + 1 < argc) {
+            optimize = atoi(argv[++i]) > 0;
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = 1;
+        } else if (strcmp(argv[i], "-b") == 0) {
+            batch = 1;
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            manifestPath = argv[++i];
+            batch = 1;
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            serverPath = argv[++i];
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            clientPath = argv[++i];
+        } else if (strcmp(argv[i], "-C") == 0 && i + 1 < argc) {
+            cachePath = argv[++i];
+        } else if (strcmp(argv[i], "-M") == 0 && i + 1 < argc) {
+            cacheSize = atoll(argv[++i]) * 1024 * 1024;
+        } else if (strcmp(argv[i], "--time-report") == 0) {
+            timeReport = 1;
+        } else if (strcmp(argv[i], "--time-report=json") == 0) {
+            timeReport = 1;
+            jsonReport = 1;
+        } else if (strcmp(argv[i], "--mem-report") == 0) {
+            memReport = 1;
+        } else if (strcmp(argv[i], "--mem-report=json") == 0) {
+            memReport = 1;
+            jsonMemReport = 1;
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            if (takesValue(argv[i])) {
+                fprintf(stderr, "The option %s needs a value!\n", argv[i]);
+            } else {
+                fprintf(stderr, "Unknown option \"%s\"!\n", argv[i]);
+            }
+            printUsage(stderr);
+            free(inputs);
+            return 1;
+        } else {
+            inputPath = argv[i];
+            inputs[nInputs++] = argv[i];
+        }
+    }
+    
+    // Only batch mode compiles several inputs, the server reads its inputs from the socket
+    if ((!batch && nInputs > 1) || (serverPath && nInputs > 0)) {
+        fprintf(stderr, serverPath ? "The server doesn't take input files!\n"
+                : "Only one input can be compiled at a time, use -b for several!\n");
+        printUsage(stderr);
+        free(inputs);
+        return 1;
+    }
+    
+    if (memReport && startMemoryStats() != 0) {
+        fprintf(stderr, "The allocations are only counted when built with -DMEMSTATS on glibc!\n");
+        memReport = 0;
+    }
+    
+    // The memory report needs the phases as well
+    phaseTimer timer;
+    initPhaseTimer(&timer);
+    phaseTimer *usedTimer = timeReport || memReport ? &timer : NULL;
+    
+    struct timespec wallStart, cpuStart;
+    clock_gettime(CLOCK_MONOTONIC, &wallStart);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpuStart);
+    
+    diskCache *cache = NULL;
+    if (cachePath) {
+        cache = openDiskCache(cachePath, cacheSize, stderr);
+        if (!cache) {
+            free(inputs);
+            return 1;
+        }
+    }
+    
+    if (batch) {
+        int success = 1;
+        if (outputPath != NULL) {
+            fprintf(stderr, "-o can't be used in batch mode, every input gets its own .asm file!\n");
+        } else if (astPath != NULL) {
+            fprintf(stderr, "-a can't be used in batch mode!\n");
+        } else {
+            success = runBatch(inputs, nInputs, manifestPath, nThreads, cache, usedTimer,
+                    optimize);
+        }
+        
+        if (timeReport) {
+            printTimeReport(&timer, secondsSince(&wallStart, CLOCK_MONOTONIC),
+                    secondsSince(&cpuStart, CLOCK_PROCESS_CPUTIME_ID), jsonReport, stderr);
+        }
+        if (memReport) {
+            printMemoryReport(jsonMemReport, stderr);
+        }
+        freeDiskCache(cache);
+        free(inputs);
+        return success;
+    }
+    free(inputs);
+    
+    if (serverPath) {
+        threadPool *pool = createThreadPool(nThreads);
+        int success = runServer(serverPath, pool, optimize);
+        freeThreadPool(pool);
+        freeDiskCache(cache);
+        return success;
+    }
+    
+    sourceBuffer source;
+    int read = 1;
+    if (inputPath) {
+        read = mapSourceFile(inputPath, &source);
+        if (read != 0) {
+            fprintf(stderr, "File couldn't be read, using stdin.\n");
+        }
+    }
+    if (read != 0 && readSource(stdin, &source) != 0) {
+        fprintf(stderr, "The input couldn't be read!\n");
+        freeDiskCache(cache);
+        return 1;
+    }
+    
+    if (clientPath) {
+        int success = runClient(clientPath, &source, outputPath);
+        freeSource(&source);
+        freeDiskCache(cache);
+        return success;
+    }
+    
+    parseContext *context = createParseContext(stderr);
+    context->timer = usedTimer;
+    context->optimize = optimize;
+    context->verbose = verbose;
+    threadPool *pool = createThreadPool(nThreads);
+    int success = compileInput(&source, context, outputPath, astPath, pool, cache);
+    
+    if (timeReport) {
+        printTimeReport(&timer, secondsSince(&wallStart, CLOCK_MONOTONIC),
+                secondsSince(&cpuStart, CLOCK_PROCESS_CPUTIME_ID), jsonReport, stderr);
+    }
+    if (memReport) {
+        printMemoryReport(jsonMemReport, stderr);
     }
     
-    freeToken(programToken);
+    freeThreadPool(pool);
+    freeParseContext(context);
+    freeSource(&source);
+    freeDiskCache(cache);
     
     return success;
 }
@@ -8,6 +8,17 @@
 #ifndef main_h
 #define main_h
 
-int handle(parseToken *programToken, int success);
+#include "parsecontext.h"
+#include "threadpool.h"
+#include "diskcache.h"
+
+int handle(parseContext *context, int success, char *outputPath, threadPool *pool);
+
+FILE *openOutput(char *outputPath, char **tmpPath, char **targetPath, FILE *errors);
+
+int closeOutput(FILE *output, char *tmpPath, char *targetPath, int success, FILE *errors);
+
+int compileBatch(char **inputs, int nInputs, threadPool *pool, diskCache *cache,
+        phaseTimer *timer, int optimize);
 
 #endif /* main_h */
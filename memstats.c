@@ -0,0 +1,153 @@
+#include "memstats.h"
+#include <string.h>
+
+// Built with -DMEMSTATS, every allocation of the process, including those inside the C library,
+// goes through the functions below. They count it if the statistics were started and pass it on
+// to the allocator of glibc. The sizes of the blocks come from malloc_usable_size. The statistics
+// are started before anything else, so hardly any block that is freed wasn't counted when it was
+// allocated. Replacing the allocator doesn't work together with the sanitizers, which replace it
+// as well, so it is left out by default. Then, or without glibc, nothing is counted.
+
+static int enabled = 0;
+static memoryStats stats;
+static __thread int currentPhase = PHASE_OTHER;
+
+#if defined(MEMSTATS) && defined(__GLIBC__)
+
+#include <malloc.h>
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+extern void __libc_free(void *pointer);
+
+static void raisePeaks(long long live) {
+    long long *peaks[2] = {&stats.peak[currentPhase], &stats.totalPeak};
+    for(int i = 0; i < 2; ++i) {
+        long long peak = __atomic_load_n(peaks[i], __ATOMIC_RELAXED);
+        while(live > peak && !__atomic_compare_exchange_n(peaks[i], &peak, live, 1,
+                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+static void addLive(long long size) {
+    long long live = __atomic_add_fetch(&stats.live, size, __ATOMIC_RELAXED);
+    if(size > 0) {
+        raisePeaks(live);
+    }
+}
+
+static void countAllocation(void *pointer, size_t size) {
+    __atomic_add_fetch(&stats.allocations[currentPhase], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&stats.requested[currentPhase], (long long) size, __ATOMIC_RELAXED);
+    if(pointer != NULL) {
+        addLive((long long) malloc_usable_size(pointer));
+    }
+}
+
+void *malloc(size_t size) {
+    void *result = __libc_malloc(size);
+    if(__atomic_load_n(&enabled, __ATOMIC_RELAXED)) {
+        countAllocation(result, size);
+    }
+    return result;
+}
+
+void *calloc(size_t count, size_t size) {
+    void *result = __libc_calloc(count, size);
+    if(__atomic_load_n(&enabled, __ATOMIC_RELAXED)) {
+        countAllocation(result, count * size);
+    }
+    return result;
+}
+
+void *realloc(void *pointer, size_t size) {
+    if(!__atomic_load_n(&enabled, __ATOMIC_RELAXED)) {
+        return __libc_realloc(pointer, size);
+    }
+    if(pointer == NULL) {
+        void *result = __libc_malloc(size);
+        countAllocation(result, size);
+        return result;
+    }
+    
+    long long oldSize = (long long) malloc_usable_size(pointer);
+    void *result = __libc_realloc(pointer, size);
+    
+    __atomic_add_fetch(&stats.reallocations[currentPhase], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&stats.requested[currentPhase], (long long) size, __ATOMIC_RELAXED);
+    if(result != NULL) {
+        long long newSize = (long long) malloc_usable_size(result);
+        // A block that was moved was in use twice while it was copied
+        if(result != pointer) {
+            raisePeaks(__atomic_load_n(&stats.live, __ATOMIC_RELAXED) + newSize);
+        }
+        addLive(newSize - oldSize);
+    } else if(size == 0) {
+        addLive(-oldSize);
+    }
+    return result;
+}
+
+void free(void *pointer) {
+    if(pointer != NULL && __atomic_load_n(&enabled, __ATOMIC_RELAXED)) {
+        addLive(-(long long) malloc_usable_size(pointer));
+    }
+    __libc_free(pointer);
+}
+
+int startMemoryStats(void) {
+    memset(&stats, 0, sizeof(stats));
+    __atomic_store_n(&enabled, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+#else
+
+int startMemoryStats(void) {
+    return 1;
+}
+
+#endif
+
+// Set by the phase timers whenever the phase of the thread changes
+void setAllocationPhase(int phase) {
+    currentPhase = phase;
+}
+
+void countCopiedBytes(size_t length) {
+    if(__atomic_load_n(&enabled, __ATOMIC_RELAXED)) {
+        __atomic_add_fetch(&stats.copied[currentPhase], (long long) length, __ATOMIC_RELAXED);
+    }
+}
+
+// The peak of a phase is the most memory in use right after one of its allocations, which
+// includes the memory of the other threads
+void printMemoryReport(int json, FILE *output) {
+    memoryStats snapshot = stats;
+    
+    if(json) {
+        fprintf(output, "{\"phases\": [");
+        for(int i = 0; i <= N_PHASES; ++i) {
+            fprintf(output, "%s{\"name\": \"%s\", \"allocations\": %ld, \"reallocations\": %ld, "
+                    "\"requestedBytes\": %lld, \"copiedBytes\": %lld, \"peakBytes\": %lld}",
+                    i > 0 ? ", " : "", phaseName(i), snapshot.allocations[i],
+                    snapshot.reallocations[i], snapshot.requested[i], snapshot.copied[i],
+                    snapshot.peak[i]);
+        }
+        fprintf(output, "], \"peakBytes\": %lld, \"liveBytes\": %lld}\n", snapshot.totalPeak,
+                snapshot.live);
+        return;
+    }
+    
+    fprintf(output, "%-12s %12s %12s %14s %14s %14s\n", "Phase", "Allocs", "Reallocs",
+            "Requested", "Copied", "Peak live");
+    for(int i = 0; i <= N_PHASES; ++i) {
+        fprintf(output, "%-12s %12ld %12ld %14lld %14lld %14lld\n", phaseName(i),
+                snapshot.allocations[i], snapshot.reallocations[i], snapshot.requested[i],
+                snapshot.copied[i], snapshot.peak[i]);
+    }
+    fprintf(output, "%-12s %12s %12s %14s %14s %14lld\n", "total", "", "", "", "",
+            snapshot.totalPeak);
+}
@@ -0,0 +1,32 @@
+#ifndef MEMSTATS_H
+#define MEMSTATS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "phasetimer.h"
+
+// Allocations outside of every phase are counted here
+#define PHASE_OTHER N_PHASES
+
+typedef struct memoryStats memoryStats;
+
+struct memoryStats {
+    long allocations[N_PHASES + 1];
+    long reallocations[N_PHASES + 1];
+    long long requested[N_PHASES + 1];
+    long long copied[N_PHASES + 1];
+    // The most memory that was in use after an allocation of the phase
+    long long peak[N_PHASES + 1];
+    long long live;
+    long long totalPeak;
+};
+
+int startMemoryStats(void);
+
+void setAllocationPhase(int phase);
+
+void countCopiedBytes(size_t length);
+
+void printMemoryReport(int json, FILE *output);
+
+#endif //MEMSTATS_H
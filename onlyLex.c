@@ -1,19 +1,31 @@
 #include "y.tab.h"
+#include "parsecontext.h"
+#include "lexer.h"
 #include <stdio.h>
 #include <string.h>
 
-extern int yylex();
 void yyerror(char *s);
 void printTokenType(int *t);
-union YYSTYPE yylval;
-void printVal();
+void printVal(YYSTYPE *yylval, parseContext *context);
 int *tokenType;
 
 int main() {
-    for (int token = yylex(); token != 0; token = yylex()) {
+    sourceBuffer source;
+    if (readSource(stdin, &source) != 0) {
+        fprintf(stderr, "The input couldn't be read!\n");
+        return 1;
+    }
+    
+    parseContext *context = createParseContext(stderr);
+    scanner sc;
+    initScanner(&sc, &source, context);
+    YYSTYPE yylval;
+    for (int token = yylex(&yylval, &sc); token != 0; token = yylex(&yylval, &sc)) {
         printTokenType(&token);
-        printVal();
+        printVal(&yylval, context);
     }
+    freeParseContext(context);
+    freeSource(&source);
     return 0;
 }
 
@@ -40,11 +52,11 @@ void yyerror (char *s)
         fprintf(stderr, "%s\n", s);
 }
 
-void printVal() {
+void printVal(YYSTYPE *yylval, parseContext *context) {
     if (*tokenType == 258) {
-        printf("Value: %d\n", yylval.value);
+        printf("Value: %d\n", yylval->value);
     } else if (*tokenType == 259) {
-        printf("Name: %s\n", yylval.name);
+        printf("Name: %s\n", symbolName(context->symbols, yylval->name));
     } else {
         printf("No value!\n");
     }
@@ -0,0 +1,91 @@
+#include "outputbuffer.h"
+#include "memstats.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_CAPACITY 64
+
+outputBuffer *createBuffer(void) {
+    outputBuffer *result = (outputBuffer *) malloc(sizeof(outputBuffer));
+    result->length = 0;
+    result->capacity = INITIAL_CAPACITY;
+    result->str = (char *) malloc(INITIAL_CAPACITY);
+    result->str[0] = '\0';
+    return result;
+}
+
+void freeBuffer(outputBuffer *buffer) {
+    if(buffer == NULL) {
+        return;
+    }
+    free(buffer->str);
+    free(buffer);
+}
+
+// Hands the collected string over to the caller and frees the buffer itself
+char *releaseBuffer(outputBuffer *buffer) {
+    char *result = buffer->str;
+    free(buffer);
+    return result;
+}
+
+int reserveCapacity(outputBuffer *buffer, size_t additional) {
+    size_t needed = buffer->length + additional + 1;
+    if(needed <= buffer->capacity) {
+        return 1;
+    }
+
+    size_t newCapacity = buffer->capacity * 2;
+    while(newCapacity < needed) {
+        newCapacity *= 2;
+    }
+
+    char *tmp = (char *) realloc(buffer->str, newCapacity);
+    if(tmp == NULL) {
+        return 0;
+    }
+
+    buffer->str = tmp;
+    buffer->capacity = newCapacity;
+    return 1;
+}
+
+void appendChars(outputBuffer *buffer, const char *str, size_t length) {
+    if(!reserveCapacity(buffer, length)) {
+        return;
+    }
+    memcpy(buffer->str + buffer->length, str, length);
+    countCopiedBytes(length);
+    buffer->length += length;
+    buffer->str[buffer->length] = '\0';
+}
+
+void appendStr(outputBuffer *buffer, const char *str) {
+    appendChars(buffer, str, strlen(str));
+}
+
+void appendInt(outputBuffer *buffer, int val) {
+    char nr[16];
+    int length = snprintf(nr, sizeof(nr), "%i", val);
+    appendChars(buffer, nr, length);
+}
+
+// Appends the content of other and frees it
+void appendBuffer(outputBuffer *buffer, outputBuffer *other) {
+    appendChars(buffer, other->str, other->length);
+    freeBuffer(other);
+}
+
+// Empties the buffer, but keeps its capacity for reuse
+void clearBuffer(outputBuffer *buffer) {
+    buffer->length = 0;
+    buffer->str[0] = '\0';
+}
+
+// Writes the content to output and empties the buffer
+int flushBuffer(outputBuffer *buffer, FILE *output) {
+    size_t length = buffer->length;
+    size_t written = fwrite(buffer->str, 1, length, output);
+    clearBuffer(buffer);
+    return written == length;
+}
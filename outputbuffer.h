@@ -0,0 +1,33 @@
+#ifndef OUTPUTBUFFER_H
+#define OUTPUTBUFFER_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+typedef struct outputBuffer outputBuffer;
+
+struct outputBuffer {
+    char *str;
+    size_t length;
+    size_t capacity;
+};
+
+outputBuffer *createBuffer(void);
+
+void freeBuffer(outputBuffer *buffer);
+
+char *releaseBuffer(outputBuffer *buffer);
+
+void appendChars(outputBuffer *buffer, const char *str, size_t length);
+
+void appendStr(outputBuffer *buffer, const char *str);
+
+void appendInt(outputBuffer *buffer, int val);
+
+void appendBuffer(outputBuffer *buffer, outputBuffer *other);
+
+void clearBuffer(outputBuffer *buffer);
+
+int flushBuffer(outputBuffer *buffer, FILE *output);
+
+#endif //OUTPUTBUFFER_H
@@ -0,0 +1,41 @@
+#include "parsecontext.h"
+#include <stdlib.h>
+
+#define MAX_KEPT_SYMBOLS (64 * 1024)
+
+parseContext *createParseContext(FILE *errors) {
+    parseContext *result = (parseContext *) malloc(sizeof(parseContext));
+    result->tokens = createArena();
+    result->symbols = createInterner();
+    result->programToken = NULL;
+    result->source = NULL;
+    result->timer = NULL;
+    result->optimize = 1;
+    result->verbose = 0;
+    result->errors = errors;
+    return result;
+}
+
+// Prepares the context for the next compilation. The parse tree is dropped, but the interned
+// names stay, unless there are so many that they should be given back.
+void resetParseContext(parseContext *context, FILE *errors) {
+    resetArena(context->tokens);
+    
+    if(context->symbols->nNames > MAX_KEPT_SYMBOLS) {
+        freeInterner(context->symbols);
+        context->symbols = createInterner();
+    }
+    
+    context->programToken = NULL;
+    context->source = NULL;
+    context->errors = errors;
+}
+
+void freeParseContext(parseContext *context) {
+    if(context == NULL) {
+        return;
+    }
+    freeArena(context->tokens);
+    freeInterner(context->symbols);
+    free(context);
+}
@@ -0,0 +1,36 @@
+#ifndef PARSECONTEXT_H
+#define PARSECONTEXT_H
+
+#include <stdio.h>
+#include "arena.h"
+#include "interner.h"
+#include "sourcebuffer.h"
+#include "phasetimer.h"
+
+typedef struct parseContext parseContext;
+
+// Everything a single compilation owns, so several compilations can run side by side
+struct parseContext {
+    arena *tokens;
+    interner *symbols;
+    struct parseToken *programToken;
+    // The text that is being parsed
+    sourceBuffer *source;
+    // Only set if the phases are timed
+    phaseTimer *timer;
+    // 0 turns off the optimization of the generated code
+    int optimize;
+    // 1 reports the statements the optimization removed
+    int verbose;
+    FILE *errors;
+};
+
+parseContext *createParseContext(FILE *errors);
+
+void freeParseContext(parseContext *context);
+
+void resetParseContext(parseContext *context, FILE *errors);
+
+int parseSource(sourceBuffer *source, parseContext *context);
+
+#endif //PARSECONTEXT_H
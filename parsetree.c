@@ -1,5 +1,4 @@
 #include "parsetree.h"
-#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
@@ -14,53 +13,77 @@ char *stringFromParseType(parseType type) {
     return values[type];
 }
 
-void initVals(parseToken *token, int n) {
+void initVals(arena *ar, parseToken *token, int n) {
     token->nVal = n;
-    token->values = (YYSTYPE *) calloc(n, sizeof(YYSTYPE));
-    token->valueTypes = (valueType *) calloc(n, sizeof(valueType));
+    token->values = (YYSTYPE *) arenaAlloc(ar, n * sizeof(YYSTYPE));
+    token->valueTypes = (valueType *) arenaAlloc(ar, n * sizeof(valueType));
 }
 
-void initNodes(parseToken *token, int n) {
+void initNodes(arena *ar, parseToken *token, int n) {
     token->nNodes = n;
-    token->subNodes = (parseToken **) calloc(n, sizeof(parseToken *));
+    token->nodesCapacity = n;
+    token->subNodes = (parseToken **) arenaAlloc(ar, n * sizeof(parseToken *));
 }
 
-void freeToken(parseToken *token)
-{
-    if(token == NULL) {
-        return;
+// Lists keep all their elements in one flat array, which doubles its capacity when it is full
+parseToken *appendToList(arena *ar, parseType type, parseToken *list, parseToken *element) {
+    if(list == NULL) {
+        list = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
+        list->type = type;
+        initVals(ar, list, 0);
+        initNodes(ar, list, 0);
     }
-
-    if(token->values != NULL) {
-        free(token->values);
+    
+    if(element == NULL) {
+        return list;
     }
     
-    for(int i = 0; i < token->nNodes; ++i) {
-        parseToken *subNode = token->subNodes[i];
-        if(subNode != NULL) {
-            freeToken(token->subNodes[i]);
-        }
+    if(list->nNodes == list->nodesCapacity) {
+        int capacity = list->nodesCapacity > 0 ? 2 * list->nodesCapacity : 4;
+        parseToken **nodes = (parseToken **) arenaAlloc(ar, capacity * sizeof(parseToken *));
+        memcpy(nodes, list->subNodes, list->nNodes * sizeof(parseToken *));
+        list->subNodes = nodes;
+        list->nodesCapacity = capacity;
     }
     
-    if(token->subNodes != NULL) {
-        free(token->subNodes);
+    list->subNodes[list->nNodes++] = element;
+    
+    return list;
+}
+
+// Copies the token and everything below it into the arena
+parseToken *copyTree(arena *ar, parseToken *tok) {
+    if(tok == NULL) {
+        return NULL;
     }
     
-    free(token);
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
+    *result = *tok;
+    
+    initVals(ar, result, tok->nVal);
+    memcpy(result->values, tok->values, tok->nVal * sizeof(YYSTYPE));
+    memcpy(result->valueTypes, tok->valueTypes, tok->nVal * sizeof(valueType));
+    
+    initNodes(ar, result, tok->nNodes);
+    for(int i = 0; i < tok->nNodes; ++i) {
+        result->subNodes[i] = copyTree(ar, tok->subNodes[i]);
+    }
+    
+    return result;
 }
 
-parseToken *createProgram(char *name, parseToken *varSections,
+parseToken *createProgram(arena *ar, int name, parseToken *varSections,
     parseToken *procedures, parseToken *body)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = program;
     
-    initVals(result, 1);
+    initVals(ar, result, 1);
     result->values[0].name = name;
     result->valueTypes[0] = string;
     
-    initNodes(result, 3);
+    initNodes(ar, result, 3);
     result->subNodes[0] = varSections;
     result->subNodes[1] = procedures;
     result->subNodes[2] = body;
@@ -68,141 +91,91 @@ parseToken *createProgram(char *name, parseToken *varSections,
     return result;
 }
 
-parseToken *createBody(parseToken *instructionSequence, char *name)
+parseToken *createBody(arena *ar, parseToken *instructionSequence, int name)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = body;
     
-    initVals(result, 1);
+    initVals(ar, result, 1);
     result->values[0].name = name;
     result->valueTypes[0] = string;
     
-    initNodes(result, 1);
+    initNodes(ar, result, 1);
     result->subNodes[0] = instructionSequence;
     
     return result;
 }
 
-parseToken *createVarSections(parseToken *prevVarSections,
+parseToken *createVarSections(arena *ar, parseToken *prevVarSections,
         parseToken *varSection)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
-    
-    result->type = varSections;
-    
-    initVals(result, 0);
-    
-    if(prevVarSections != NULL) {
-        initNodes(result, 2);
-        result->subNodes[0] = prevVarSections;
-        result->subNodes[1] = varSection;
-    } else if(varSection != NULL) {
-        initNodes(result, 1);
-        result->subNodes[0] = varSection;
-    } else {
-        initNodes(result, 0);
-    }
-    
-    return result;
+    return appendToList(ar, varSections, prevVarSections, varSection);
 }
 
-parseToken *createVarSection(parseToken *varDeclarations)
+parseToken *createVarSection(arena *ar, parseToken *varDeclarations)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = varSection;
     
-    initVals(result, 0);
+    initVals(ar, result, 0);
     
-    initNodes(result, 1);
+    initNodes(ar, result, 1);
     result->subNodes[0] = varDeclarations;
     
     return result;
 }
 
-parseToken *createVarDeclarations(parseToken *prevVarDeclarations,
+parseToken *createVarDeclarations(arena *ar, parseToken *prevVarDeclarations,
         parseToken *varDeclaration)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
-    
-    result->type = varDeclarations;
-    
-    initVals(result, 0);
-    
-    if(prevVarDeclarations != NULL) {
-        initNodes(result, 2);
-        result->subNodes[0] = prevVarDeclarations;
-        result->subNodes[1] = varDeclaration;
-    } else {
-        initNodes(result, 1);
-        result->subNodes[0] = varDeclaration;
-    }
-    
-    return result;
-
+    return appendToList(ar, varDeclarations, prevVarDeclarations, varDeclaration);
 }
 
-parseToken *createVarDeclaration( char *name, const int *arraySize)
+parseToken *createVarDeclaration(arena *ar, int name, const int *arraySize)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = varDeclaration;
     
     if(arraySize != NULL) {
-        initVals(result, 2);
+        initVals(ar, result, 2);
         result->values[1].value = *arraySize;
         result->valueTypes[1] = number;
     } else {
-        initVals(result, 1);
+        initVals(ar, result, 1);
     }
     
     result->values[0].name = name;
     result->valueTypes[0] = string;
     
-    initNodes(result, 0);
+    initNodes(ar, result, 0);
     
     return result;
 
 }
 
-parseToken *createProcedures(parseToken *prevProcedures, parseToken *procedure)
+parseToken *createProcedures(arena *ar, parseToken *prevProcedures, parseToken *procedure)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
-    
-    result->type = procedures;
-    
-    initVals(result, 0);
-    
-    if(prevProcedures != NULL) {
-        initNodes(result, 2);
-        result->subNodes[0] = prevProcedures;
-        result->subNodes[1] = procedure;
-    } else if(procedure != NULL) {
-        initNodes(result, 1);
-        result->subNodes[0] = procedure;
-    } else {
-        initNodes(result, 0);
-    }
-    
-    return result;
+    return appendToList(ar, procedures, prevProcedures, procedure);
 }
 
-parseToken *createProcedure(parseToken *header, char *name, parseToken *paramList,
+parseToken *createProcedure(arena *ar, parseToken *header, int name, parseToken *paramList,
         parseToken *varSection, parseToken *instructionSequence,
-        char *confirmIdentifier)
+        int confirmIdentifier)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = procedure;
     
-    initVals(result, 2);
+    initVals(ar, result, 2);
     result->values[0].name = name;
     result->valueTypes[0] = string;
     result->values[1].name = confirmIdentifier;
     result->valueTypes[1] = string;
     
-    initNodes(result, 4);
+    initNodes(ar, result, 4);
     result->subNodes[0] = header;
     result->subNodes[1] = paramList;
     result->subNodes[2] = varSection;
@@ -212,117 +185,84 @@ parseToken *createProcedure(parseToken *header, char *name, parseToken *paramLis
     
 }
 
-parseToken *createProcedureHeader( void )
+parseToken *createProcedureHeader(arena *ar)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = procedureHeader;
     
-    initVals(result, 0);
+    initVals(ar, result, 0);
     
-    initNodes(result, 0);
+    initNodes(ar, result, 0);
         
     return result;
 
 }
 
-parseToken *createFunctionHeader( void )
+parseToken *createFunctionHeader(arena *ar)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = functionHeader;
     
-    initVals(result, 0);
+    initVals(ar, result, 0);
     
-    initNodes(result, 0);
+    initNodes(ar, result, 0);
         
     return result;
 
 }
 
-parseToken *createParamList(parseToken *prevParamList, parseToken *parameter)
+parseToken *createParamList(arena *ar, parseToken *prevParamList, parseToken *parameter)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
-    
-    result->type = paramList;
-    
-    initVals(result, 0);
-    
-    if(prevParamList != NULL) {
-        initNodes(result, 2);
-        result->subNodes[0] = prevParamList;
-        result->subNodes[1] = parameter;
-    } else if(parameter != NULL) {
-        initNodes(result, 1);
-        result->subNodes[0] = parameter;
-    } else {
-        initNodes(result, 0);
-    }
-    
-    return result;
-
+    return appendToList(ar, paramList, prevParamList, parameter);
 }
 
-parseToken *createCopyParameter(parseToken *varDeclaration)
+parseToken *createCopyParameter(arena *ar, parseToken *varDeclaration)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = copyParameter;
     
-    initVals(result, 0);
+    initVals(ar, result, 0);
     
-    initNodes(result, 1);
+    initNodes(ar, result, 1);
     result->subNodes[0] = varDeclaration;
     
     return result;
 
 }
 
-parseToken *createReferenceParameter(parseToken *varDeclaration)
+parseToken *createReferenceParameter(arena *ar, parseToken *varDeclaration)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = referenceParameter;
     
-    initVals(result, 0);
+    initVals(ar, result, 0);
     
-    initNodes(result, 1);
+    initNodes(ar, result, 1);
     result->subNodes[0] = varDeclaration;
     
     return result;
 
 }
 
-parseToken *createInstructionSequence(parseToken *newInstruction,
-        parseToken *prevInstructionSequence)
+parseToken *createInstructionSequence(arena *ar, parseToken *prevInstructionSequence,
+        parseToken *newInstruction)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
-    
-    result->type = instructionSequence;
-    
-    initVals(result, 0);
-    
-    if(prevInstructionSequence != NULL) {
-        initNodes(result, 2);
-        result->subNodes[1] = prevInstructionSequence;
-    } else {
-        initNodes(result, 1);
-    }
-    result->subNodes[0] = newInstruction;
-    
-    return result;
-
+    return appendToList(ar, instructionSequence, prevInstructionSequence, newInstruction);
 }
 
-parseToken *createAssignment(parseToken *var, parseToken *expr)
+parseToken *createAssignment(arena *ar, parseToken *var, parseToken *expr)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = assignment;
     
-    initVals(result, 0);
+    initVals(ar, result, 0);
     
-    initNodes(result, 2);
+    initNodes(ar, result, 2);
     result->subNodes[0] = var;
     result->subNodes[1] = expr;
     
@@ -330,47 +270,47 @@ parseToken *createAssignment(parseToken *var, parseToken *expr)
 
 }
 
-parseToken *createVarCall(char *name)
+parseToken *createVarCall(arena *ar, int name)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = varCall;
     
-    initVals(result, 1);
+    initVals(ar, result, 1);
     result->values[0].name = name;
     result->valueTypes[0] = string;
     
-    initNodes(result, 0);
+    initNodes(ar, result, 0);
     
     return result;
 }
 
-parseToken *createArrayCall(char *name, parseToken *index)
+parseToken *createArrayCall(arena *ar, int name, parseToken *index)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = arrayCall;
     
-    initVals(result, 1);
+    initVals(ar, result, 1);
     result->values[0].name = name;
     result->valueTypes[0] = string;
     
-    initNodes(result, 1);
+    initNodes(ar, result, 1);
     result->subNodes[0] = index;
     
     return result;
 }
 
-parseToken *createConditional(parseToken *cond,
+parseToken *createConditional(arena *ar, parseToken *cond,
         parseToken *instructions, parseToken *elseSection)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = conditionalInstruction;
     
-    initVals(result, 0);
+    initVals(ar, result, 0);
     
-    initNodes(result, 3);
+    initNodes(ar, result, 3);
     result->subNodes[0] = cond;
     result->subNodes[1] = instructions;
     result->subNodes[2] = elseSection;
@@ -379,34 +319,34 @@ parseToken *createConditional(parseToken *cond,
 
 }
 
-parseToken *createElseSection(parseToken *instructions)
+parseToken *createElseSection(arena *ar, parseToken *instructions)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = elseSection;
     
-    initVals(result, 0);
+    initVals(ar, result, 0);
     
     if(instructions != NULL) {
-        initNodes(result, 1);
+        initNodes(ar, result, 1);
         result->subNodes[0] = instructions;
     } else {
-        initNodes(result, 0);
+        initNodes(ar, result, 0);
     }
     
     return result;
 
 }
 
-parseToken *createWhileLoop(parseToken *condition, parseToken *instrutions)
+parseToken *createWhileLoop(arena *ar, parseToken *condition, parseToken *instrutions)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = whileLoop;
     
-    initVals(result, 0);
+    initVals(ar, result, 0);
     
-    initNodes(result, 2);
+    initNodes(ar, result, 2);
     result->subNodes[0] = condition;
     result->subNodes[1] = instrutions;
     
@@ -414,15 +354,15 @@ parseToken *createWhileLoop(parseToken *condition, parseToken *instrutions)
 
 }
 
-parseToken *createRepeatLoop(parseToken *instructions, parseToken *condition)
+parseToken *createRepeatLoop(arena *ar, parseToken *instructions, parseToken *condition)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = repeatLoop;
     
-    initVals(result, 0);
+    initVals(ar, result, 0);
     
-    initNodes(result, 2);
+    initNodes(ar, result, 2);
     result->subNodes[0] = instructions;
     result->subNodes[1] = condition;
     
@@ -430,16 +370,16 @@ parseToken *createRepeatLoop(parseToken *instructions, parseToken *condition)
 
 }
 
-parseToken *createForLoop(parseToken *assignment,
+parseToken *createForLoop(arena *ar, parseToken *assignment,
         parseToken *target, parseToken *iteration, parseToken *instructions)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = forLoop;
     
-    initVals(result, 0);
+    initVals(ar, result, 0);
     
-    initNodes(result, 4);
+    initNodes(ar, result, 4);
     result->subNodes[0] = assignment;
     result->subNodes[1] = target;
     result->subNodes[2] = iteration;
@@ -449,93 +389,75 @@ parseToken *createForLoop(parseToken *assignment,
 
 }
 
-parseToken *createPositiveAdvancement(int num)
+parseToken *createPositiveAdvancement(arena *ar, int num)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = positiveAdvancement;
     
-    initVals(result, 1);
+    initVals(ar, result, 1);
     result->values[0].value = num;
         result->valueTypes[0] = number;
 
     
-    initNodes(result, 0);
+    initNodes(ar, result, 0);
     
     return result;
 
 }
 
-parseToken *createNegativeAdvancement(int num)
+parseToken *createNegativeAdvancement(arena *ar, int num)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = negativeAdvancement;
     
-    initVals(result, 1);
+    initVals(ar, result, 1);
     result->values[0].value = num;
         result->valueTypes[0] = number;
 
     
-    initNodes(result, 0);
+    initNodes(ar, result, 0);
     
     return result;
 
 }
 
-parseToken *createProcedureCall(char *name, parseToken *paramList)
+parseToken *createProcedureCall(arena *ar, int name, parseToken *paramList)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = procedureCall;
     
-    initVals(result, 1);
+    initVals(ar, result, 1);
     result->values[0].name = name;
     result->valueTypes[0] = string;
     
-    initNodes(result, 1);
+    initNodes(ar, result, 1);
     result->subNodes[0] = paramList;
     
     return result;
 
 }
 
-parseToken *createParamListCall(parseToken *prevParams, parseToken *param)
+parseToken *createParamListCall(arena *ar, parseToken *prevParams, parseToken *param)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
-    
-    result->type = paramListCall;
-    
-    initVals(result, 0);
-    
-    if(prevParams != NULL) {
-        initNodes(result, 2);
-        result->subNodes[0] = prevParams;
-        result->subNodes[1] = param;
-    } else if(param != NULL) {
-        initNodes(result, 1);
-        result->subNodes[0] = param;
-    } else {
-        initNodes(result, 0);
-    }
-    
-    return result;
-
+    return appendToList(ar, paramListCall, prevParams, param);
 }
 
-parseToken *createReturnStatement(parseToken *returnedExpression)
+parseToken *createReturnStatement(arena *ar, parseToken *returnedExpression)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = returnStatement;
     
-    initVals(result, 0);
+    initVals(ar, result, 0);
     
     if(returnedExpression != NULL) {
-        initNodes(result, 1);
+        initNodes(ar, result, 1);
         result->subNodes[0] = returnedExpression;
     } else {
-        initNodes(result, 0);
+        initNodes(ar, result, 0);
     }
     
     return result;
@@ -543,18 +465,18 @@ parseToken *createReturnStatement(parseToken *returnedExpression)
 
 }
 
-parseToken *createCondition(parseToken *firstOp, int opCode, parseToken *secondOp)
+parseToken *createCondition(arena *ar, parseToken *firstOp, int opCode, parseToken *secondOp)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = condition;
     
-    initVals(result, 1);
+    initVals(ar, result, 1);
     result->values[0].value = opCode;
         result->valueTypes[0] = number;
 
     
-    initNodes(result, 2);
+    initNodes(ar, result, 2);
     result->subNodes[0] = firstOp;
     result->subNodes[1] = secondOp;
     
@@ -562,48 +484,48 @@ parseToken *createCondition(parseToken *firstOp, int opCode, parseToken *secondO
 
 }
 
-parseToken *createBrackets(parseToken *internal)
+parseToken *createBrackets(arena *ar, parseToken *internal)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = expression;
     
-    initVals(result, 0);
+    initVals(ar, result, 0);
     
-    initNodes(result, 1);
+    initNodes(ar, result, 1);
     result->subNodes[0] = internal;
     
     return result;
 
 }
 
-parseToken *createNegation(parseToken *internal)
+parseToken *createNegation(arena *ar, parseToken *internal)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = negation;
     
-    initVals(result, 0);
+    initVals(ar, result, 0);
     
-    initNodes(result, 1);
+    initNodes(ar, result, 1);
     result->subNodes[0] = internal;
     
     return result;
 
 }
 
-parseToken *createBinaryExpression(parseToken *firstOp, int opCode, parseToken *secondOp)
+parseToken *createBinaryExpression(arena *ar, parseToken *firstOp, int opCode, parseToken *secondOp)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = expression;
     
-    initVals(result, 1);
+    initVals(ar, result, 1);
     result->values[0].value = opCode;
         result->valueTypes[0] = number;
 
     
-    initNodes(result, 2);
+    initNodes(ar, result, 2);
     result->subNodes[0] = firstOp;
     result->subNodes[1] = secondOp;
     
@@ -611,46 +533,46 @@ parseToken *createBinaryExpression(parseToken *firstOp, int opCode, parseToken *
 
 }
 
-parseToken *createUnaryExpression(parseToken *value)
+parseToken *createUnaryExpression(arena *ar, parseToken *value)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = expression;
     
-    initVals(result, 0);
+    initVals(ar, result, 0);
     
-    initNodes(result, 1);
+    initNodes(ar, result, 1);
     result->subNodes[0] = value;
     
     return result;
 }
 
-parseToken *createValue(int num)
+parseToken *createValue(arena *ar, int num)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = value;
     
-    initVals(result, 1);
+    initVals(ar, result, 1);
     result->values[0].value = num;
         result->valueTypes[0] = number;
 
     
-    initNodes(result, 0);
+    initNodes(ar, result, 0);
     
     return result;
 
 }
 
-parseToken *createValueByCall(parseToken *call)
+parseToken *createValueByCall(arena *ar, parseToken *call)
 {
-    parseToken *result = (parseToken *) malloc(sizeof(parseToken));
+    parseToken *result = (parseToken *) arenaAlloc(ar, sizeof(parseToken));
     
     result->type = value;
     
-    initVals(result, 0);
+    initVals(ar, result, 0);
     
-    initNodes(result, 1);
+    initNodes(ar, result, 1);
     result->subNodes[0] = call;
     
     return result;
@@ -2,6 +2,7 @@
 #define PARSETREE_H
 
 #include "y.tab.h"
+#include "arena.h"
 
 typedef enum parseType parseType;
 
@@ -51,6 +52,31 @@ enum valueType {
     token
 };
 
+typedef enum varCallType varCallType;
+
+enum varCallType {
+    callFailure,
+
+    singleValue,
+    valueInArray,
+    wholeArray,
+
+    singleValueLocal,
+    valueInArrayLocal,
+    wholeArrayLocal
+};
+
+typedef enum expressionType expressionType;
+
+enum expressionType {
+    exprFailure,
+
+    computedValue,
+    singleValueVar,
+    literalValue,
+    array
+};
+
 typedef struct parseToken parseToken;
 
 struct parseToken {
@@ -60,86 +86,94 @@ struct parseToken {
     int nVal;
     parseToken **subNodes;
     int nNodes;
+    int nodesCapacity;
+    
+    // Filled in by the semantic pass before the code generation
+    int annotated;
+    expressionType exprType;
+    varCallType callType;
+    int symbol;
+    int arraySize;
 };
 
-void freeToken(parseToken *token);
+parseToken *copyTree(arena *ar, parseToken *tok);
 
-parseToken *createProgram(char *name, parseToken *varSections,
+parseToken *createProgram(arena *ar, int name, parseToken *varSections,
         parseToken *procedures, parseToken *body);
 
-parseToken *createBody(parseToken *instructionSequence, char *name);
+parseToken *createBody(arena *ar, parseToken *instructionSequence, int name);
 
-parseToken *createVarSections(parseToken *prevVarSections,
+parseToken *createVarSections(arena *ar, parseToken *prevVarSections,
         parseToken *varSection);
 
-parseToken *createVarSection(parseToken *varDeclarations);
+parseToken *createVarSection(arena *ar, parseToken *varDeclarations);
 
-parseToken *createVarDeclarations(parseToken *prevVarDeclarations,
+parseToken *createVarDeclarations(arena *ar, parseToken *prevVarDeclarations,
         parseToken *varDeclaration);
 
-parseToken *createVarDeclaration( char *name, const int *arraySize);
+parseToken *createVarDeclaration(arena *ar, int name, const int *arraySize);
 
-parseToken *createProcedures(parseToken *prevProcedures, parseToken *procedure);
+parseToken *createProcedures(arena *ar, parseToken *prevProcedures, parseToken *procedure);
 
-parseToken *createProcedure(parseToken *header, char *name, parseToken *paramList,
+parseToken *createProcedure(arena *ar, parseToken *header, int name, parseToken *paramList,
         parseToken *varSection, parseToken *instructionSequence,
-        char *confirmIdentifier);
+        int confirmIdentifier);
 
-parseToken *createProcedureHeader( void );
+parseToken *createProcedureHeader(arena *ar);
 
-parseToken *createFunctionHeader( void );
+parseToken *createFunctionHeader(arena *ar);
 
-parseToken *createParamList(parseToken *prevParamList, parseToken *parameter);
+parseToken *createParamList(arena *ar, parseToken *prevParamList, parseToken *parameter);
 
-parseToken *createCopyParameter(parseToken *varDeclaration);
+parseToken *createCopyParameter(arena *ar, parseToken *varDeclaration);
 
-parseToken *createReferenceParameter(parseToken *varDeclaration);
+parseToken *createReferenceParameter(arena *ar, parseToken *varDeclaration);
 
-parseToken *createInstructionSequence(parseToken *newInstruction,
-        parseToken *prevInstructionSequence);
+parseToken *createInstructionSequence(arena *ar, parseToken *prevInstructionSequence,
+        parseToken *newInstruction);
 
-parseToken *createAssignment(parseToken *var, parseToken *expr);
+parseToken *createAssignment(arena *ar, parseToken *var, parseToken *expr);
 
-parseToken *createVarCall(char *name);
+parseToken *createVarCall(arena *ar, int name);
 
-parseToken *createArrayCall(char *name, parseToken *index);
+parseToken *createArrayCall(arena *ar, int name, parseToken *index);
 
-parseToken *createConditional(parseToken *cond,
+parseToken *createConditional(arena *ar, parseToken *cond,
         parseToken *instructions, parseToken *elseSection);
 
-parseToken *createElseSection(parseToken *instructions);
+parseToken *createElseSection(arena *ar, parseToken *instructions);
 
-parseToken *createWhileLoop(parseToken *condition, parseToken *instrutions);
+parseToken *createWhileLoop(arena *ar, parseToken *condition, parseToken *instrutions);
 
-parseToken *createRepeatLoop(parseToken *instructions, parseToken *condition);
+parseToken *createRepeatLoop(arena *ar, parseToken *instructions, parseToken *condition);
 
-parseToken *createForLoop(parseToken *assignment,
+parseToken *createForLoop(arena *ar, parseToken *assignment,
         parseToken *target, parseToken *iteration, parseToken *instructions);
 
-parseToken *createPositiveAdvancement(int num);
+parseToken *createPositiveAdvancement(arena *ar, int num);
 
-parseToken *createNegativeAdvancement(int num);
+parseToken *createNegativeAdvancement(arena *ar, int num);
 
-parseToken *createEmptyAdvancement( void );
+parseToken *createEmptyAdvancement(arena *ar);
 
-parseToken *createProcedureCall(char *name, parseToken *paramList);
+parseToken *createProcedureCall(arena *ar, int name, parseToken *paramList);
 
-parseToken *createParamListCall(parseToken *prevParams, parseToken *param);
+parseToken *createParamListCall(arena *ar, parseToken *prevParams, parseToken *param);
 
-parseToken *createReturnStatement(parseToken *returnedExpression);
+parseToken *createReturnStatement(arena *ar, parseToken *returnedExpression);
 
-parseToken *createCondition(parseToken *firstOp, int opCode, parseToken *secondOp);
+parseToken *createCondition(arena *ar, parseToken *firstOp, int opCode, parseToken *secondOp);
 
-parseToken *createBrackets(parseToken *internal);
+parseToken *createBrackets(arena *ar, parseToken *internal);
 
-parseToken *createNegation(parseToken *internal);
+parseToken *createNegation(arena *ar, parseToken *internal);
 
-parseToken *createBinaryExpression(parseToken *firstOp, int opCode, parseToken *secondOp);
+parseToken *createBinaryExpression(arena *ar, parseToken *firstOp, int opCode, parseToken *secondOp);
 
-parseToken *createUnaryExpression(parseToken *value);
+parseToken *createUnaryExpression(arena *ar, parseToken *value);
 
-parseToken *createValue(int num);
+parseToken *createValue(arena *ar, int num);
 
-parseToken *createValueByCall(parseToken *call);
+parseToken *createValueByCall(arena *ar, parseToken *call);
 
 #endif //PARSETREE_H
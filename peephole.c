@@ -0,0 +1,293 @@
+#include "peephole.h"
+#include "accumulator.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+// Instead of an opcode, the rule is tried after every instruction that isn't a label
+#define ANY_INSTRUCTION N_OPCODES
+
+typedef struct peepholeRule peepholeRule;
+
+// A rule looks at the end of the instructions that were kept so far and rewrites them in place.
+// It returns 1 if it changed them. Rules never add instructions, so the kept instructions can be
+// compacted into the list they are read from.
+struct peepholeRule {
+    int last;   // The opcode the instructions of the rule end with
+    int (*rewrite)(machineInstruction *code, int *length);
+};
+
+static int sameOperand(operand *a, operand *b) {
+    return a->addressing == b->addressing && a->base == b->base && a->value == b->value;
+}
+
+static int isNumber(operand *arg, addressing mode) {
+    return arg->addressing == mode && arg->base == baseNumber;
+}
+
+static int isTopOfStack(operand *arg) {
+    return arg->addressing == addressAbsolute && arg->base == baseStack && arg->value == 0;
+}
+
+// After these the next instruction is only reached by a jump
+static int endsFlow(opcode op) {
+    return op == opJmp || op == opRts || op == opHold;
+}
+
+// STORE x, LOAD x: the accumulator still holds x
+static int removeLoadAfterStore(machineInstruction *code, int *length) {
+    if(*length < 2) {
+        return 0;
+    }
+    machineInstruction *first = &code[*length - 2];
+    machineInstruction *second = &code[*length - 1];
+    if(first->opcode != opStore || second->opcode != opLoad
+            || !sameOperand(&first->arg, &second->arg)) {
+        return 0;
+    }
+    --*length;
+    return 1;
+}
+
+// LOAD x, STORE x: x already holds the accumulator
+static int removeStoreAfterLoad(machineInstruction *code, int *length) {
+    if(*length < 2) {
+        return 0;
+    }
+    machineInstruction *first = &code[*length - 2];
+    machineInstruction *second = &code[*length - 1];
+    if(first->opcode != opLoad || second->opcode != opStore
+            || !sameOperand(&first->arg, &second->arg)) {
+        return 0;
+    }
+    --*length;
+    return 1;
+}
+
+// LOAD a, LOAD b: the first value is never used
+static int removeOverwrittenLoad(machineInstruction *code, int *length) {
+    if(*length < 2 || code[*length - 2].opcode != opLoad || code[*length - 1].opcode != opLoad) {
+        return 0;
+    }
+    code[*length - 2] = code[*length - 1];
+    --*length;
+    return 1;
+}
+
+// PUSH, LOAD 0(SP): the accumulator still holds what was pushed
+static int removeLoadAfterPush(machineInstruction *code, int *length) {
+    if(*length < 2 || code[*length - 2].opcode != opPush || code[*length - 1].opcode != opLoad
+            || !isTopOfStack(&code[*length - 1].arg)) {
+        return 0;
+    }
+    --*length;
+    return 1;
+}
+
+// REL $n, PUSH: the released word is pushed again, so it is overwritten instead
+static int replaceReleaseAndPush(machineInstruction *code, int *length) {
+    if(*length < 2) {
+        return 0;
+    }
+    machineInstruction *release = &code[*length - 2];
+    if(release->opcode != opRel || !isNumber(&release->arg, addressImmediate)
+            || release->arg.value < 1 || code[*length - 1].opcode != opPush) {
+        return 0;
+    }
+    
+    machineInstruction *store = &code[*length - 1];
+    store->opcode = opStore;
+    store->arg = stackOperand(addressAbsolute, 0);
+    if(--release->arg.value == 0) {
+        *release = *store;
+        --*length;
+    }
+    return 1;
+}
+
+// REL $a, REL $b and RSV a, RSV b are done at once, REL $0 and RSV 0 not at all
+static int mergeStackChanges(machineInstruction *code, int *length) {
+    if(*length < 1) {
+        return 0;
+    }
+    machineInstruction *last = &code[*length - 1];
+    if(last->opcode != opRel && last->opcode != opRsv) {
+        return 0;
+    }
+    if(last->arg.base != baseNumber) {
+        return 0;
+    }
+    
+    if(last->arg.value == 0) {
+        --*length;
+        return 1;
+    }
+    
+    if(*length < 2) {
+        return 0;
+    }
+    machineInstruction *first = &code[*length - 2];
+    if(first->opcode != last->opcode || first->arg.base != baseNumber
+            || first->arg.addressing != last->arg.addressing) {
+        return 0;
+    }
+    first->arg.value += last->arg.value;
+    --*length;
+    return 1;
+}
+
+// Jumps to one of the labels right after them don't change anything
+static int removeJumpToNext(machineInstruction *code, int *length) {
+    if(*length < 2 || code[*length - 1].opcode != opLabel) {
+        return 0;
+    }
+    
+    int jump = *length - 2;
+    while(jump >= 0 && code[jump].opcode == opLabel) {
+        --jump;
+    }
+    if(jump < 0 || !isJump(code[jump].opcode)) {
+        return 0;
+    }
+    
+    operand *target = &code[jump].arg;
+    int label = jump + 1;
+    while(label < *length && (code[label].arg.base != target->base
+            || code[label].arg.value != target->value)) {
+        ++label;
+    }
+    if(label == *length) {
+        return 0;
+    }
+    
+    memmove(&code[jump], &code[jump + 1], (*length - jump - 1) * sizeof(machineInstruction));
+    --*length;
+    return 1;
+}
+
+// Nothing but a label can be reached after a JMP, RTS or HOLD
+static int removeUnreachable(machineInstruction *code, int *length) {
+    if(*length < 2 || code[*length - 1].opcode == opLabel || !endsFlow(code[*length - 2].opcode)) {
+        return 0;
+    }
+    --*length;
+    return 1;
+}
+
+// LOAD $0, SUB $n: the negation of a constant is loaded directly. It doesn't set the flags like
+// the subtraction, so it is kept before a conditional jump.
+static int foldNegatedConstant(machineInstruction *code, int *length) {
+    if(*length < 3) {
+        return 0;
+    }
+    machineInstruction *load = &code[*length - 3];
+    machineInstruction *sub = &code[*length - 2];
+    machineInstruction *next = &code[*length - 1];
+    if(load->opcode != opLoad || !isNumber(&load->arg, addressImmediate) || load->arg.value != 0
+            || sub->opcode != opSub || !isNumber(&sub->arg, addressImmediate)
+            || sub->arg.value == INT_MIN || (isJump(next->opcode) && next->opcode != opJmp)) {
+        return 0;
+    }
+    
+    load->arg.value = -sub->arg.value;
+    *sub = *next;
+    --*length;
+    return 1;
+}
+
+static const peepholeRule rules[] = {
+    {ANY_INSTRUCTION, removeUnreachable},
+    {opLabel, removeJumpToNext},
+    {opLoad, removeLoadAfterStore},
+    {opStore, removeStoreAfterLoad},
+    {opLoad, removeOverwrittenLoad},
+    {opLoad, removeLoadAfterPush},
+    {opPush, replaceReleaseAndPush},
+    {opRel, mergeStackChanges},
+    {opRsv, mergeStackChanges},
+    {ANY_INSTRUCTION, foldNegatedConstant}
+};
+
+#define N_RULES ((int) (sizeof(rules) / sizeof(rules[0])))
+
+static int ruleApplies(const peepholeRule *rule, machineInstruction *code, int length) {
+    int last = code[length - 1].opcode;
+    return rule->last == last || (rule->last == ANY_INSTRUCTION && last != opLabel);
+}
+
+// Slides over the instructions once. Every kept instruction is matched against the rules that end
+// with it until none applies anymore, so a rewrite can enable another one before it.
+static void applyRules(instructionList *list) {
+    machineInstruction *code = list->code;
+    int length = 0;
+    
+    for(int i = 0; i < list->length; ++i) {
+        code[length++] = code[i];
+        
+        int rule = 0;
+        while(rule < N_RULES && length > 0) {
+            if(ruleApplies(&rules[rule], code, length) && rules[rule].rewrite(code, &length)) {
+                rule = 0;
+            } else {
+                ++rule;
+            }
+        }
+    }
+    
+    list->length = length;
+}
+
+// Numbered markers are only used inside of their section, so the ones no jump refers to anymore
+// are removed. That lets the rules look past them.
+static int removeUnusedMarkers(instructionList *list) {
+    int min = INT_MAX;
+    int max = INT_MIN;
+    for(int i = 0; i < list->length; ++i) {
+        operand *arg = &list->code[i].arg;
+        if(list->code[i].opcode == opLabel && arg->base == baseMarker) {
+            min = arg->value < min ? arg->value : min;
+            max = arg->value > max ? arg->value : max;
+        }
+    }
+    if(min > max) {
+        return 0;
+    }
+    
+    unsigned char *used = (unsigned char *) calloc((size_t) (max - min) + 1, 1);
+    if(used == NULL) {
+        return 0;
+    }
+    for(int i = 0; i < list->length; ++i) {
+        operand *arg = &list->code[i].arg;
+        if(list->code[i].opcode != opLabel && arg->base == baseMarker
+                && arg->value >= min && arg->value <= max) {
+            used[arg->value - min] = 1;
+        }
+    }
+    
+    int length = 0;
+    for(int i = 0; i < list->length; ++i) {
+        operand *arg = &list->code[i].arg;
+        if(list->code[i].opcode == opLabel && arg->base == baseMarker && !used[arg->value - min]) {
+            continue;
+        }
+        list->code[length++] = list->code[i];
+    }
+    free(used);
+    
+    int changed = length != list->length;
+    list->length = length;
+    return changed;
+}
+
+// Rewrites the instructions of a section into shorter ones that do the same, until none of the
+// rules applies anymore. One pass reaches that, unless loads or labels were removed afterwards.
+// Named labels stay, as other sections can jump to them.
+void optimizeInstructions(instructionList *list) {
+    int changed;
+    do {
+        applyRules(list);
+        changed = removeRedundantLoads(list);
+        changed |= removeUnusedMarkers(list);
+    } while(changed);
+}
@@ -0,0 +1,8 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include "instructions.h"
+
+void optimizeInstructions(instructionList *list);
+
+#endif //PEEPHOLE_H
@@ -0,0 +1,109 @@
+#include "phasetimer.h"
+#include "memstats.h"
+#include <string.h>
+
+static const char *phaseNames[N_PHASES + 1] = {
+    "lexing", "parsing", "codegen", "variables", "procedures", "body", "optimization",
+    "output", "other"
+};
+
+const char *phaseName(int phase) {
+    return phaseNames[phase];
+}
+
+static double elapsed(const struct timespec *start, const struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+void initPhaseTimer(phaseTimer *timer) {
+    memset(timer, 0, sizeof(phaseTimer));
+}
+
+// Charges the time since the last change to the phase on top of the stack
+static void chargeCurrentPhase(phaseTimer *timer) {
+    struct timespec wall, cpu;
+    clock_gettime(CLOCK_MONOTONIC, &wall);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+    
+    if(timer->depth > 0 && !timer->paused) {
+        compilerPhase phase = timer->stack[timer->depth - 1];
+        timer->wall[phase] += elapsed(&timer->wallStart, &wall);
+        timer->cpu[phase] += elapsed(&timer->cpuStart, &cpu);
+    }
+    
+    timer->wallStart = wall;
+    timer->cpuStart = cpu;
+}
+
+// Does nothing without a timer, so the callers don't have to check whether timing is enabled
+void enterPhase(phaseTimer *timer, compilerPhase phase) {
+    if(timer == NULL || timer->depth == MAX_PHASE_DEPTH) {
+        return;
+    }
+    chargeCurrentPhase(timer);
+    timer->stack[timer->depth++] = phase;
+    ++timer->count[phase];
+    setAllocationPhase(phase);
+}
+
+void leavePhase(phaseTimer *timer) {
+    if(timer == NULL || timer->depth == 0) {
+        return;
+    }
+    chargeCurrentPhase(timer);
+    --timer->depth;
+    setAllocationPhase(timer->depth > 0 ? (int) timer->stack[timer->depth - 1] : PHASE_OTHER);
+}
+
+// While other threads do work that is timed with their own timers
+void pausePhases(phaseTimer *timer) {
+    if(timer == NULL) {
+        return;
+    }
+    chargeCurrentPhase(timer);
+    timer->paused = 1;
+}
+
+void resumePhases(phaseTimer *timer) {
+    if(timer == NULL) {
+        return;
+    }
+    chargeCurrentPhase(timer);
+    timer->paused = 0;
+    // A task that ran on this thread meanwhile may have changed the phase of the allocations
+    setAllocationPhase(timer->depth > 0 ? (int) timer->stack[timer->depth - 1] : PHASE_OTHER);
+}
+
+void mergePhaseTimes(phaseTimer *timer, const phaseTimer *other) {
+    if(timer == NULL) {
+        return;
+    }
+    for(int i = 0; i < N_PHASES; ++i) {
+        timer->wall[i] += other->wall[i];
+        timer->cpu[i] += other->cpu[i];
+        timer->count[i] += other->count[i];
+    }
+}
+
+// The times of the procedures are summed over all threads, so with several threads the sum of
+// the phases can be more than the total wall time
+void printTimeReport(phaseTimer *timer, double totalWall, double totalCpu, int json, FILE *output) {
+    if(json) {
+        fprintf(output, "{\"phases\": [");
+        for(int i = 0; i < N_PHASES; ++i) {
+            fprintf(output, "%s{\"name\": \"%s\", \"wallMs\": %.3f, \"cpuMs\": %.3f, \"count\": %ld}",
+                    i > 0 ? ", " : "", phaseNames[i], timer->wall[i] * 1000,
+                    timer->cpu[i] * 1000, timer->count[i]);
+        }
+        fprintf(output, "], \"totalWallMs\": %.3f, \"totalCpuMs\": %.3f}\n",
+                totalWall * 1000, totalCpu * 1000);
+        return;
+    }
+    
+    fprintf(output, "%-12s %12s %12s %10s\n", "Phase", "Wall (ms)", "CPU (ms)", "Count");
+    for(int i = 0; i < N_PHASES; ++i) {
+        fprintf(output, "%-12s %12.3f %12.3f %10ld\n", phaseNames[i], timer->wall[i] * 1000,
+                timer->cpu[i] * 1000, timer->count[i]);
+    }
+    fprintf(output, "%-12s %12.3f %12.3f\n", "total", totalWall * 1000, totalCpu * 1000);
+}
@@ -0,0 +1,54 @@
+#ifndef PHASETIMER_H
+#define PHASETIMER_H
+
+#include <stdio.h>
+#include <time.h>
+
+typedef enum compilerPhase compilerPhase;
+
+enum compilerPhase {
+    phaseLexing,
+    phaseParsing,
+    phaseCodegen,
+    phaseVariables,
+    phaseProcedures,
+    phaseBody,
+    phaseOptimization,
+    phaseOutput,
+    N_PHASES
+};
+
+#define MAX_PHASE_DEPTH 16
+
+typedef struct phaseTimer phaseTimer;
+
+// The time of a phase doesn't include the phases started inside of it. A timer belongs to one
+// thread, the timers of other threads are merged into it afterwards.
+struct phaseTimer {
+    double wall[N_PHASES];
+    double cpu[N_PHASES];
+    long count[N_PHASES];
+    compilerPhase stack[MAX_PHASE_DEPTH];
+    int depth;
+    int paused;
+    struct timespec wallStart;
+    struct timespec cpuStart;
+};
+
+const char *phaseName(int phase);
+
+void initPhaseTimer(phaseTimer *timer);
+
+void enterPhase(phaseTimer *timer, compilerPhase phase);
+
+void leavePhase(phaseTimer *timer);
+
+void pausePhases(phaseTimer *timer);
+
+void resumePhases(phaseTimer *timer);
+
+void mergePhaseTimes(phaseTimer *timer, const phaseTimer *other);
+
+void printTimeReport(phaseTimer *timer, double totalWall, double totalCpu, int json, FILE *output);
+
+#endif //PHASETIMER_H
@@ -0,0 +1,180 @@
+#include "procedurecache.h"
+#include "symboltable.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_BUCKETS 4096
+#define MAX_CACHED_PROCEDURES 65536
+
+procedureHash addToHash(procedureHash hash, const void *data, size_t length) {
+    const unsigned char *bytes = (const unsigned char *) data;
+    for(size_t i = 0; i < length; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+procedureHash addIntToHash(procedureHash hash, int value) {
+    return addToHash(hash, &value, sizeof(value));
+}
+
+procedureCache *createProcedureCache(void) {
+    procedureCache *cache = (procedureCache *) malloc(sizeof(procedureCache));
+    cache->nBuckets = CACHE_BUCKETS;
+    cache->buckets = (cachedProcedure **) calloc(cache->nBuckets, sizeof(cachedProcedure *));
+    cache->nEntries = 0;
+    cache->generation = 0;
+    pthread_mutex_init(&cache->lock, NULL);
+    return cache;
+}
+
+void freeCachedProcedure(cachedProcedure *entry) {
+    freeInstructions(entry->code);
+    for(int i = 0; i < entry->nNames; ++i) {
+        free(entry->names[i]);
+    }
+    free(entry->names);
+    free(entry->errors);
+    free(entry);
+}
+
+// Has to be called with the lock held. Only the entries used since the given generation stay.
+void dropEntriesBefore(procedureCache *cache, unsigned int generation) {
+    for(int i = 0; i < cache->nBuckets; ++i) {
+        cachedProcedure **link = &cache->buckets[i];
+        while(*link != NULL) {
+            cachedProcedure *entry = *link;
+            if(entry->lastUse < generation) {
+                *link = entry->next;
+                freeCachedProcedure(entry);
+                --(cache->nEntries);
+            } else {
+                link = &entry->next;
+            }
+        }
+    }
+}
+
+void freeProcedureCache(procedureCache *cache) {
+    if(cache == NULL) {
+        return;
+    }
+
+    dropEntriesBefore(cache, (unsigned int) -1);
+    free(cache->buckets);
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+}
+
+// Every compilation starts a generation, entries unused for the longest time are dropped first
+void startCacheGeneration(procedureCache *cache) {
+    pthread_mutex_lock(&cache->lock);
+    ++(cache->generation);
+    pthread_mutex_unlock(&cache->lock);
+}
+
+cachedProcedure **findEntry(procedureCache *cache, procedureHash tree, procedureHash dependencies) {
+    cachedProcedure **link = &cache->buckets[(tree ^ dependencies) % cache->nBuckets];
+    while(*link != NULL && ((*link)->tree != tree || (*link)->dependencies != dependencies)) {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
+// On a hit the assembly is printed with its markers moved to the given base and the diagnostics
+// are handed out as a new string
+int findCachedProcedure(procedureCache *cache, procedureHash tree, procedureHash dependencies,
+        int markerBase, outputBuffer *assembly, char **errors, size_t *errorsLength, int *returnVal) {
+    pthread_mutex_lock(&cache->lock);
+
+    cachedProcedure *entry = *findEntry(cache, tree, dependencies);
+    if(entry == NULL) {
+        pthread_mutex_unlock(&cache->lock);
+        return 0;
+    }
+
+    entry->lastUse = cache->generation;
+    printCode(entry->code, entry->names, markerBase - entry->markerBase, assembly);
+
+    *errors = NULL;
+    *errorsLength = entry->errorsLength;
+    if(entry->errorsLength > 0) {
+        *errors = (char *) malloc(entry->errorsLength);
+        memcpy(*errors, entry->errors, entry->errorsLength);
+    }
+    *returnVal = entry->returnVal;
+
+    pthread_mutex_unlock(&cache->lock);
+    return 1;
+}
+
+char *copyChars(const char *str, size_t length) {
+    char *result = (char *) malloc(length + 1);
+    if(length > 0) {
+        memcpy(result, str, length);
+    }
+    result[length] = '\0';
+    return result;
+}
+
+// Copies the code with its symbols replaced by indexes into the names of the entry
+void copyCode(cachedProcedure *entry, instructionList *code, interner *symbols) {
+    symbolTable *indexes = createSymbolTable();
+    entry->code = createInstructions();
+    entry->names = NULL;
+    entry->nNames = 0;
+    
+    for(int i = 0; i < code->length; ++i) {
+        operand arg = code->code[i].arg;
+        
+        if(arg.base == baseSymbol) {
+            int index = lookupSymbol(indexes, arg.value);
+            if(index < 0) {
+                index = entry->nNames++;
+                entry->names = (char **) realloc(entry->names, entry->nNames * sizeof(char *));
+                entry->names[index] = strdup(symbolName(symbols, arg.value));
+                insertSymbol(indexes, arg.value, index);
+            }
+            arg.value = index;
+        }
+        appendInstruction(entry->code, (opcode) code->code[i].opcode, arg);
+    }
+    
+    freeSymbolTable(indexes);
+}
+
+void storeCachedProcedure(procedureCache *cache, procedureHash tree, procedureHash dependencies,
+        int markerBase, instructionList *code, interner *symbols, const char *errors,
+        size_t errorsLength, int returnVal) {
+    pthread_mutex_lock(&cache->lock);
+
+    if(*findEntry(cache, tree, dependencies) != NULL) {
+        pthread_mutex_unlock(&cache->lock);
+        return;
+    }
+
+    if(cache->nEntries >= MAX_CACHED_PROCEDURES) {
+        dropEntriesBefore(cache, cache->generation);
+    }
+    if(cache->nEntries >= MAX_CACHED_PROCEDURES) {
+        dropEntriesBefore(cache, cache->generation + 1);
+    }
+
+    cachedProcedure *entry = (cachedProcedure *) malloc(sizeof(cachedProcedure));
+    entry->tree = tree;
+    entry->dependencies = dependencies;
+    copyCode(entry, code, symbols);
+    entry->errors = copyChars(errors, errorsLength);
+    entry->errorsLength = errorsLength;
+    entry->returnVal = returnVal;
+    entry->markerBase = markerBase;
+    entry->lastUse = cache->generation;
+
+    cachedProcedure **link = findEntry(cache, tree, dependencies);
+    entry->next = NULL;
+    *link = entry;
+    ++(cache->nEntries);
+
+    pthread_mutex_unlock(&cache->lock);
+}
@@ -0,0 +1,61 @@
+#ifndef PROCEDURECACHE_H
+#define PROCEDURECACHE_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include "outputbuffer.h"
+#include "instructions.h"
+#include "interner.h"
+
+typedef unsigned long long procedureHash;
+
+#define EMPTY_HASH 14695981039346656037ull
+
+typedef struct cachedProcedure cachedProcedure;
+
+// The code is kept as instructions, so only the numbered markers are moved when it is used with
+// another base. The interner belongs to the compilation, so the symbols are indexes into names.
+struct cachedProcedure {
+    procedureHash tree;
+    procedureHash dependencies;
+    instructionList *code;
+    char **names;
+    int nNames;
+    char *errors;
+    size_t errorsLength;
+    int returnVal;
+    int markerBase;
+    unsigned int lastUse;
+    cachedProcedure *next;
+};
+
+typedef struct procedureCache procedureCache;
+
+// The generated code of procedures, kept between compilations. A procedure is found by the
+// hash of its tree and the hash of the signatures and globals it was generated against.
+struct procedureCache {
+    cachedProcedure **buckets;
+    int nBuckets;
+    int nEntries;
+    unsigned int generation;
+    pthread_mutex_t lock;
+};
+
+procedureHash addToHash(procedureHash hash, const void *data, size_t length);
+
+procedureHash addIntToHash(procedureHash hash, int value);
+
+procedureCache *createProcedureCache(void);
+
+void freeProcedureCache(procedureCache *cache);
+
+void startCacheGeneration(procedureCache *cache);
+
+int findCachedProcedure(procedureCache *cache, procedureHash tree, procedureHash dependencies,
+        int markerBase, outputBuffer *assembly, char **errors, size_t *errorsLength, int *returnVal);
+
+void storeCachedProcedure(procedureCache *cache, procedureHash tree, procedureHash dependencies,
+        int markerBase, instructionList *code, interner *symbols, const char *errors,
+        size_t errorsLength, int returnVal);
+
+#endif //PROCEDURECACHE_H
@@ -0,0 +1,496 @@
+#include "programgenerator.h"
+#include <stdlib.h>
+
+#define N_GLOBALS 8
+#define N_LOCALS 4
+#define MAX_PARAMS 3
+// Calls nest at most this deep, the loops around them multiply how often the callees run
+#define CALL_LEVELS 3
+
+typedef struct procedureInfo procedureInfo;
+
+struct procedureInfo {
+    int isFunction;
+    // Only procedures of a lower level are called
+    int callLevel;
+    int nParams;
+    int paramIsReference[MAX_PARAMS];
+};
+
+typedef struct generator generator;
+
+// The program is written while it is generated, only the signatures of the procedures are kept,
+// so later procedures can call them with the right arguments
+struct generator {
+    const generatorOptions *options;
+    FILE *output;
+    uint64_t state;
+    long lines;
+    int indent;
+    procedureInfo *procedures;
+    int nProcedures;
+    int nPerLevel[CALL_LEVELS];
+    int nFunctionsPerLevel[CALL_LEVELS];
+    // The level of the procedure that is generated and how many procedures it can call
+    int callLevel;
+    int nCallable;
+    int nCallableFunctions;
+    // How many loops are around the statement that is generated
+    int loops;
+    int globalArraySize;
+    // The procedure that is generated, NULL in the body
+    procedureInfo *current;
+    int localArraySize;
+};
+
+void generateExpression(generator *gen, int depth);
+
+void generateSequence(generator *gen, int level, int length);
+
+void initGeneratorOptions(generatorOptions *options) {
+    options->seed = 1;
+    options->lines = 1000;
+    options->procedures = 0;
+    options->statements = 20;
+    options->expressionDepth = 3;
+    options->nestingDepth = 3;
+    options->arraySize = 16;
+    options->callDensity = 10;
+}
+
+// splitmix64, so the programs don't depend on the rand() of the C library
+uint64_t nextRandom(generator *gen) {
+    uint64_t z = (gen->state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+int randomBelow(generator *gen, int bound) {
+    return (int) (nextRandom(gen) % (uint64_t) bound);
+}
+
+int chance(generator *gen, int percent) {
+    return randomBelow(gen, 100) < percent;
+}
+
+void beginLine(generator *gen) {
+    for(int i = 0; i < gen->indent; ++i) {
+        fputs("    ", gen->output);
+    }
+}
+
+void endLine(generator *gen) {
+    fputc('\n', gen->output);
+    ++gen->lines;
+}
+
+void writeProcedureName(generator *gen, int index) {
+    fprintf(gen->output, "%c%i", gen->procedures[index].isFunction ? 'f' : 'p', index);
+}
+
+// A scalar that can be assigned: a parameter or local of the procedure or a global
+// The VAR parameters aren't used: the compiler reads them as the address of the argument, which
+// depends on the stack, so the results would change with every optimization that changes it
+void generateScalar(generator *gen) {
+    int params[MAX_PARAMS];
+    int nParams = 0;
+    for(int i = 0; gen->current != NULL && i < gen->current->nParams; ++i) {
+        if(!gen->current->paramIsReference[i]) {
+            params[nParams++] = i;
+        }
+    }
+    int nLocals = gen->current != NULL ? N_LOCALS : 0;
+    int choice = randomBelow(gen, nParams + nLocals + N_GLOBALS);
+    
+    if(choice < nParams) {
+        fprintf(gen->output, "x%i", params[choice]);
+    } else if(choice < nParams + nLocals) {
+        fprintf(gen->output, "v%i", choice - nParams);
+    } else {
+        fprintf(gen->output, "g%i", choice - nParams - nLocals);
+    }
+}
+
+void generateArrayElement(generator *gen) {
+    int local = gen->current != NULL && chance(gen, 50);
+    int size = local ? gen->localArraySize : gen->globalArraySize;
+    
+    fputs(local ? "la[" : "ga[", gen->output);
+    if(chance(gen, 50)) {
+        fprintf(gen->output, "%i", randomBelow(gen, size));
+    } else {
+        // The remainder keeps the sign, so the index is moved into the array like this. Writes
+        // outside of it would change the return addresses.
+        fputc('(', gen->output);
+        generateScalar(gen);
+        fprintf(gen->output, " %% %i + %i) %% %i", size, size, size);
+    }
+    fputc(']', gen->output);
+}
+
+void generateVariable(generator *gen) {
+    if(chance(gen, 20)) {
+        generateArrayElement(gen);
+    } else {
+        generateScalar(gen);
+    }
+}
+
+void setCallLevel(generator *gen, int level) {
+    gen->callLevel = level;
+    gen->nCallable = 0;
+    gen->nCallableFunctions = 0;
+    for(int i = 0; i < level && i < CALL_LEVELS; ++i) {
+        gen->nCallable += gen->nPerLevel[i];
+        gen->nCallableFunctions += gen->nFunctionsPerLevel[i];
+    }
+}
+
+// Procedures only call others outside of their loops, so the work of a call doesn't multiply
+// with every level of calls
+int canCall(generator *gen, int function) {
+    if(gen->current != NULL && gen->loops > 0) {
+        return 0;
+    }
+    return function ? gen->nCallableFunctions > 0 : gen->nCallable > 0;
+}
+
+// Only the procedures before the current one are called, so there is no recursion
+void generateCall(generator *gen, int function, int depth) {
+    int index;
+    do {
+        index = randomBelow(gen, gen->nProcedures);
+    } while(gen->procedures[index].callLevel >= gen->callLevel
+            || (function && !gen->procedures[index].isFunction));
+    
+    procedureInfo *callee = &gen->procedures[index];
+    writeProcedureName(gen, index);
+    fputc('(', gen->output);
+    
+    for(int i = 0; i < callee->nParams; ++i) {
+        if(i > 0) {
+            fputs(", ", gen->output);
+        }
+        if(callee->paramIsReference[i]) {
+            generateScalar(gen);
+        } else {
+            generateExpression(gen, depth);
+        }
+    }
+    fputc(')', gen->output);
+}
+
+void generateOperand(generator *gen, int depth) {
+    // The arguments are less deep than the call, so calls don't nest without end
+    if(depth > 0 && canCall(gen, 1) && chance(gen, gen->options->callDensity)) {
+        generateCall(gen, 1, depth - 1);
+    } else if(chance(gen, 30)) {
+        fprintf(gen->output, "%i", randomBelow(gen, 256));
+    } else {
+        generateVariable(gen);
+    }
+}
+
+void generateExpression(generator *gen, int depth) {
+    if(depth <= 0 || chance(gen, 25)) {
+        generateOperand(gen, depth);
+        return;
+    }
+    
+    int kind = randomBelow(gen, 10);
+    if(kind == 0) {
+        fputs("-(", gen->output);
+        generateExpression(gen, depth - 1);
+        fputc(')', gen->output);
+    } else if(kind == 1) {
+        fputc('(', gen->output);
+        generateExpression(gen, depth - 1);
+        fputc(')', gen->output);
+    } else {
+        static const char operators[] = "+-*/%";
+        char operator = operators[randomBelow(gen, 5)];
+        
+        generateExpression(gen, depth - 1);
+        fprintf(gen->output, " %c ", operator);
+        // Divisions only by constants that aren't 0
+        if(operator == '/' || operator == '%') {
+            fprintf(gen->output, "%i", randomBelow(gen, 9) + 1);
+        } else {
+            generateExpression(gen, depth - 1);
+        }
+    }
+}
+
+void generateCondition(generator *gen) {
+    static const char *comparisons[] = {"=", "<>", "<", ">", "<=", ">="};
+    int depth = gen->options->expressionDepth > 0 ? gen->options->expressionDepth - 1 : 0;
+    
+    generateExpression(gen, depth);
+    fprintf(gen->output, " %s ", comparisons[randomBelow(gen, 6)]);
+    generateExpression(gen, depth);
+}
+
+void generateReturn(generator *gen) {
+    beginLine(gen);
+    fputs("RETURN ", gen->output);
+    generateExpression(gen, gen->options->expressionDepth);
+    fputc(';', gen->output);
+    endLine(gen);
+}
+
+// Every level has its own counter, so nested loops don't share one. The other statements never
+// assign the counters.
+void writeCounter(generator *gen, int level) {
+    fprintf(gen->output, "%c%i", gen->current != NULL ? 'k' : 'i', level);
+}
+
+void generateCounterStart(generator *gen, int level) {
+    beginLine(gen);
+    writeCounter(gen, level);
+    fprintf(gen->output, " := %i;", randomBelow(gen, 5));
+    endLine(gen);
+}
+
+// The last statement of the loop
+void generateCountDown(generator *gen, int level) {
+    ++gen->indent;
+    beginLine(gen);
+    writeCounter(gen, level);
+    fputs(" := ", gen->output);
+    writeCounter(gen, level);
+    fputs(" - 1;", gen->output);
+    endLine(gen);
+    --gen->indent;
+}
+
+void generateBlock(generator *gen, int level) {
+    ++gen->indent;
+    generateSequence(gen, level + 1, randomBelow(gen, 3) + 1);
+    --gen->indent;
+}
+
+void generateLoopBlock(generator *gen, int level) {
+    ++gen->loops;
+    generateBlock(gen, level);
+    --gen->loops;
+}
+
+void generateStatement(generator *gen, int level) {
+    int compound = level < gen->options->nestingDepth;
+    int kind = randomBelow(gen, 100);
+    
+    if(canCall(gen, 0) && chance(gen, gen->options->callDensity)) {
+        beginLine(gen);
+        generateCall(gen, 0, gen->options->expressionDepth);
+        fputc(';', gen->output);
+        endLine(gen);
+    } else if(!compound || kind < 55) {
+        beginLine(gen);
+        generateVariable(gen);
+        fputs(" := ", gen->output);
+        generateExpression(gen, gen->options->expressionDepth);
+        fputc(';', gen->output);
+        endLine(gen);
+    } else if(kind < 75) {
+        beginLine(gen);
+        fputs("IF ", gen->output);
+        generateCondition(gen);
+        fputs(" THEN", gen->output);
+        endLine(gen);
+        generateBlock(gen, level);
+        
+        if(chance(gen, 50)) {
+            beginLine(gen);
+            fputs("ELSE", gen->output);
+            endLine(gen);
+            generateBlock(gen, level);
+        }
+        
+        beginLine(gen);
+        fputs("END;", gen->output);
+        endLine(gen);
+    } else if(kind < 83) {
+        // The loops count down with the counter of their level, so they always end
+        generateCounterStart(gen, level);
+        beginLine(gen);
+        fputs("WHILE ", gen->output);
+        writeCounter(gen, level);
+        fputs(" > 0 DO", gen->output);
+        endLine(gen);
+        generateLoopBlock(gen, level);
+        generateCountDown(gen, level);
+        beginLine(gen);
+        fputs("END;", gen->output);
+        endLine(gen);
+    } else if(kind < 90) {
+        generateCounterStart(gen, level);
+        beginLine(gen);
+        fputs("REPEAT", gen->output);
+        endLine(gen);
+        generateLoopBlock(gen, level);
+        generateCountDown(gen, level);
+        beginLine(gen);
+        fputs("UNTIL ", gen->output);
+        writeCounter(gen, level);
+        fputs(" <= 0;", gen->output);
+        endLine(gen);
+    } else {
+        // Constant bounds, so the loop doesn't run until the counter overflows
+        int first = randomBelow(gen, 5);
+        int last = first + randomBelow(gen, 7) - 1;
+        int step = randomBelow(gen, 4);
+        beginLine(gen);
+        fputs("FOR ", gen->output);
+        writeCounter(gen, level);
+        if(step == 2) {
+            fprintf(gen->output, " := %i TO %i BY -%i", last, first, randomBelow(gen, 4) + 1);
+        } else if(step == 1) {
+            fprintf(gen->output, " := %i TO %i BY %i", first, last, randomBelow(gen, 4) + 1);
+        } else {
+            fprintf(gen->output, " := %i TO %i", first, last);
+        }
+        fputs(" DO", gen->output);
+        endLine(gen);
+        generateLoopBlock(gen, level);
+        beginLine(gen);
+        fputs("END;", gen->output);
+        endLine(gen);
+    }
+}
+
+void generateSequence(generator *gen, int level, int length) {
+    for(int i = 0; i < length; ++i) {
+        // Functions sometimes return early
+        if(gen->current != NULL && gen->current->isFunction && level > 0 && chance(gen, 2)) {
+            generateReturn(gen);
+        } else {
+            generateStatement(gen, level);
+        }
+    }
+}
+
+void writeCounters(generator *gen, char prefix) {
+    for(int i = 0; i < gen->options->nestingDepth; ++i) {
+        fprintf(gen->output, ", %c%i", prefix, i);
+    }
+}
+
+// The locals are on the stack, which holds whatever was there before, so each of them gets a value
+// before any statement can read it
+void generateLocalValues(generator *gen) {
+    beginLine(gen);
+    for(int i = 0; i < N_LOCALS; ++i) {
+        fprintf(gen->output, "%sv%i := %i;", i > 0 ? " " : "", i, randomBelow(gen, 256));
+    }
+    endLine(gen);
+    
+    beginLine(gen);
+    for(int i = 0; i < gen->localArraySize; ++i) {
+        fprintf(gen->output, "%sla[%i] := %i;", i > 0 ? " " : "", i, randomBelow(gen, 256));
+    }
+    endLine(gen);
+}
+
+int generateProcedure(generator *gen) {
+    if(gen->nProcedures % 1024 == 0) {
+        procedureInfo *procedures = realloc(gen->procedures,
+                (gen->nProcedures + 1024) * sizeof(procedureInfo));
+        if(procedures == NULL) {
+            return 1;
+        }
+        gen->procedures = procedures;
+    }
+    
+    int index = gen->nProcedures;
+    procedureInfo *proc = &gen->procedures[index];
+    proc->isFunction = chance(gen, 50);
+    proc->callLevel = index % CALL_LEVELS;
+    proc->nParams = randomBelow(gen, MAX_PARAMS + 1);
+    
+    beginLine(gen);
+    fputs(proc->isFunction ? "FUNCTION " : "PROCEDURE ", gen->output);
+    writeProcedureName(gen, index);
+    fputc('(', gen->output);
+    for(int i = 0; i < proc->nParams; ++i) {
+        proc->paramIsReference[i] = chance(gen, 30);
+        fprintf(gen->output, "%s%sx%i", i > 0 ? ", " : "",
+                proc->paramIsReference[i] ? "VAR " : "", i);
+    }
+    fputs(");", gen->output);
+    endLine(gen);
+    
+    gen->localArraySize = randomBelow(gen, gen->options->arraySize) + 1;
+    fputs("VAR v0, v1, v2, v3", gen->output);
+    writeCounters(gen, 'k');
+    fprintf(gen->output, ", la[%i];", gen->localArraySize);
+    endLine(gen);
+    
+    fputs("BEGIN", gen->output);
+    endLine(gen);
+    
+    gen->current = proc;
+    setCallLevel(gen, proc->callLevel);
+    gen->indent = 1;
+    generateLocalValues(gen);
+    generateSequence(gen, 0, gen->options->statements);
+    if(proc->isFunction) {
+        generateReturn(gen);
+    }
+    gen->indent = 0;
+    gen->current = NULL;
+    
+    fputs("END ", gen->output);
+    writeProcedureName(gen, index);
+    fputc(';', gen->output);
+    endLine(gen);
+    endLine(gen);
+    
+    // Only now it can be called
+    ++gen->nProcedures;
+    ++gen->nPerLevel[proc->callLevel];
+    gen->nFunctionsPerLevel[proc->callLevel] += proc->isFunction;
+    return 0;
+}
+
+// Writes a program of the options to the output and returns the number of its lines, or -1 if
+// there was not enough memory
+long generateProgram(const generatorOptions *options, FILE *output) {
+    generator gen = {0};
+    gen.options = options;
+    gen.output = output;
+    gen.state = options->seed;
+    
+    fputs("PROGRAM Generated;", output);
+    endLine(&gen);
+    
+    gen.globalArraySize = randomBelow(&gen, options->arraySize) + 1;
+    fputs("VAR g0", output);
+    for(int i = 1; i < N_GLOBALS; ++i) {
+        fprintf(output, ", g%i", i);
+    }
+    writeCounters(&gen, 'i');
+    fprintf(output, ", ga[%i];", gen.globalArraySize);
+    endLine(&gen);
+    endLine(&gen);
+    
+    while(options->procedures > 0 ? gen.nProcedures < options->procedures
+            : gen.lines < options->lines) {
+        if(generateProcedure(&gen) != 0) {
+            free(gen.procedures);
+            return -1;
+        }
+    }
+    
+    fputs("BEGIN", output);
+    endLine(&gen);
+    setCallLevel(&gen, CALL_LEVELS);
+    gen.indent = 1;
+    generateSequence(&gen, 0, options->statements);
+    gen.indent = 0;
+    fputs("END Generated.", output);
+    endLine(&gen);
+    
+    free(gen.procedures);
+    return gen.lines;
+}
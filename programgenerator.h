@@ -0,0 +1,25 @@
+#ifndef PROGRAMGENERATOR_H
+#define PROGRAMGENERATOR_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+typedef struct generatorOptions generatorOptions;
+
+// The same options and seed always produce the same program
+struct generatorOptions {
+    uint64_t seed;
+    long lines;             // Procedures are added until the program has this many lines
+    int procedures;         // An exact number of procedures instead, if it isn't 0
+    int statements;         // Statements in the outermost sequence of a procedure
+    int expressionDepth;    // Most operators an expression is nested in
+    int nestingDepth;       // Most control structures a statement is nested in
+    int arraySize;          // Largest size of a declared array
+    int callDensity;        // Percent of the statements and operands that are calls
+};
+
+void initGeneratorOptions(generatorOptions *options);
+
+long generateProgram(const generatorOptions *options, FILE *output);
+
+#endif //PROGRAMGENERATOR_H
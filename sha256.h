@@ -0,0 +1,23 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct sha256Context sha256Context;
+
+struct sha256Context {
+    uint32_t state[8];
+    uint64_t length;
+    unsigned char block[64];
+    size_t used;
+};
+
+void sha256Init(sha256Context *context);
+
+void sha256Update(sha256Context *context, const void *data, size_t length);
+
+// Writes the digest as 64 lowercase hex digits and a terminating null
+void sha256Hex(sha256Context *context, char *hex);
+
+#endif //SHA256_H
@@ -0,0 +1,379 @@
+#include "simplifier.h"
+
+typedef enum operatorType operatorType;
+
+// The values the parser stores for the operators of a binary expression
+enum operatorType {
+    operatorAdd,
+    operatorSubtract,
+    operatorMultiply,
+    operatorDivide,
+    operatorModulo
+};
+
+int getRecursiveExpressionValue(parseToken *tok) {
+    switch(tok->type) {
+        case negation:
+            return -1 * getRecursiveExpressionValue(tok->subNodes[0]);
+        case value:
+            return tok->values[0].value;
+        default:
+            if(tok->nNodes == 2) {
+                parseToken *leftSide = tok->subNodes[0];
+                parseToken *rightSide = tok->subNodes[1];
+                int leftValue = getRecursiveExpressionValue(leftSide);
+                int rightValue = getRecursiveExpressionValue(rightSide);
+                int operator = tok->values[0].value;
+                switch(operator) {
+                    case 1:
+                        return leftValue - rightValue;
+                    case 2:
+                        return leftValue * rightValue;
+                    case 3:
+                        // -1 is left out, the smallest int divided by it traps
+                        return rightValue == -1 ? (int) -(unsigned int) leftValue
+                                : leftValue / rightValue;
+                    case 4:
+                        return rightValue == -1 ? 0 : leftValue % rightValue;
+                    default:
+                        return leftValue + rightValue;
+                }
+            } else {
+                return getRecursiveExpressionValue(tok->subNodes[0]);
+            }
+    }
+}
+
+// The value a constant has in a word of the machine
+int toWord(int value) {
+    return ((value & 0xFFFF) ^ 0x8000) - 0x8000;
+}
+
+// Computes an operation the way the machine does, on words
+static int foldWords(int operator, int left, int right) {
+    switch(operator) {
+        case operatorSubtract:
+            return toWord(left - right);
+        case operatorMultiply:
+            return toWord(left * right);
+        case operatorDivide:
+            return toWord(left / right);
+        case operatorModulo:
+            return toWord(left % right);
+        default:
+            return toWord(left + right);
+    }
+}
+
+static int isExpression(parseToken *tok) {
+    return tok->type == expression || tok->type == negation || tok->type == value;
+}
+
+static int isLiteral(parseToken *tok) {
+    return tok->exprType == literalValue;
+}
+
+static int isBinary(parseToken *tok, operatorType operator) {
+    return tok->type == expression && tok->nNodes == 2 && tok->values[0].value == (int) operator;
+}
+
+// Like getExpressionUnderlyingVarCall: the expression can be passed to a VAR parameter
+static int isVariable(parseToken *tok) {
+    if(tok->type == expression && tok->nNodes == 1) {
+        return isVariable(tok->subNodes[0]);
+    }
+    return tok->type == value && tok->nNodes == 1 && tok->subNodes[0]->type == varCall;
+}
+
+// Calls can have side effects, so expressions containing one are never dropped
+int hasCall(parseToken *tok) {
+    if(tok->type == procedureCall) {
+        return 1;
+    }
+    for(int i = 0; i < tok->nNodes; ++i) {
+        if(hasCall(tok->subNodes[i])) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Like canBeOnSP: an array element, whose address is computed first, but which is read last
+static int isArrayElement(parseToken *tok) {
+    if((tok->type == expression && tok->nNodes == 1) || (tok->type == value && tok->nNodes > 0)) {
+        return isArrayElement(tok->subNodes[0]);
+    }
+    return tok->type == arrayCall;
+}
+
+// Like getWithoutNegation, the code generation turns x + -y into x - y and x - -y into x + y
+static parseToken *getNegated(parseToken *tok) {
+    if(tok->type == negation) {
+        return tok->subNodes[0];
+    }
+    if(tok->type == expression && tok->nNodes == 1) {
+        return getNegated(tok->subNodes[0]);
+    }
+    return NULL;
+}
+
+static int isComputedFirst(parseToken *tok, int dropsNegation) {
+    for(parseToken *inner = dropsNegation ? getNegated(tok) : NULL; inner != NULL;
+            inner = getNegated(inner)) {
+        tok = inner;
+    }
+    return tok->exprType == computedValue && !isArrayElement(tok);
+}
+
+static parseToken *simplifyExpression(parseToken *tok, arena *tokens);
+
+// The code generation computes a second operand that is an expression before the first one, but
+// reads a variable or an array element only after it. If the first operand has a call that could
+// change them, the second one is only simplified when this keeps the order. As simplifying changes
+// the expression, a copy is simplified then, so the original can still be used.
+static parseToken *simplifySecond(parseToken *first, parseToken *second, arena *tokens,
+        int dropsNegation) {
+    if(!hasCall(first) || !isComputedFirst(second, dropsNegation)) {
+        return simplifyExpression(second, tokens);
+    }
+    
+    parseToken *simplified = simplifyExpression(copyTree(tokens, second), tokens);
+    if(!isLiteral(simplified) && !isComputedFirst(simplified, dropsNegation)) {
+        return second;
+    }
+    return simplified;
+}
+
+static int sameExpression(parseToken *a, parseToken *b) {
+    if(a->type != b->type || a->nNodes != b->nNodes || a->nVal != b->nVal) {
+        return 0;
+    }
+    
+    switch(a->type) {
+        case varCall:
+        case arrayCall:
+            if(a->values[0].name != b->values[0].name || a->callType != b->callType
+                    || a->symbol != b->symbol) {
+                return 0;
+            }
+            break;
+        case value:
+        case expression:
+            if(a->nVal == 1 && a->values[0].value != b->values[0].value) {
+                return 0;
+            }
+            break;
+        default:
+            break;
+    }
+    
+    for(int i = 0; i < a->nNodes; ++i) {
+        if(!sameExpression(a->subNodes[i], b->subNodes[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// A constant that is already annotated, as the code generation expects it
+static parseToken *createLiteral(arena *tokens, int num) {
+    parseToken *result = createValue(tokens, num);
+    result->annotated = 1;
+    result->exprType = literalValue;
+    return result;
+}
+
+// (x + a) + b, (x - a) + b, ... become x + (a + b) or x - (a + b)
+static parseToken *mergeAdditions(parseToken *tok, arena *tokens) {
+    parseToken *left = tok->subNodes[0];
+    if(!(isBinary(left, operatorAdd) || isBinary(left, operatorSubtract))
+            || !isLiteral(left->subNodes[1])) {
+        return tok;
+    }
+    
+    int first = toWord(getRecursiveExpressionValue(left->subNodes[1]));
+    int second = toWord(getRecursiveExpressionValue(tok->subNodes[1]));
+    if(isBinary(left, operatorSubtract)) {
+        first = -first;
+    }
+    if(isBinary(tok, operatorSubtract)) {
+        second = -second;
+    }
+    
+    int sum = toWord(first + second);
+    if(sum == 0) {
+        return left->subNodes[0];
+    }
+    
+    tok->subNodes[0] = left->subNodes[0];
+    if(sum < 0 && sum != toWord(0x8000)) {
+        tok->values[0].value = operatorSubtract;
+        tok->subNodes[1] = createLiteral(tokens, -sum);
+    } else {
+        tok->values[0].value = operatorAdd;
+        tok->subNodes[1] = createLiteral(tokens, sum);
+    }
+    return tok;
+}
+
+// (x * a) * b becomes x * (a * b)
+static parseToken *mergeMultiplications(parseToken *tok, arena *tokens) {
+    parseToken *left = tok->subNodes[0];
+    if(!isBinary(left, operatorMultiply) || !isLiteral(left->subNodes[1])) {
+        return tok;
+    }
+    
+    int first = toWord(getRecursiveExpressionValue(left->subNodes[1]));
+    int second = toWord(getRecursiveExpressionValue(tok->subNodes[1]));
+    int product = toWord(first * second);
+    
+    if(product == 1) {
+        return left->subNodes[0];
+    }
+    if(product == 0 && !hasCall(left->subNodes[0])) {
+        return createLiteral(tokens, 0);
+    }
+    
+    tok->subNodes[0] = left->subNodes[0];
+    tok->subNodes[1] = createLiteral(tokens, product);
+    return tok;
+}
+
+static parseToken *simplifyNegation(parseToken *tok, arena *tokens) {
+    int wasLiteral = isLiteral(tok);
+    parseToken *inner = simplifyExpression(tok->subNodes[0], tokens);
+    
+    if(wasLiteral) {
+        return createLiteral(tokens, getRecursiveExpressionValue(tok));
+    }
+    if(isLiteral(inner)) {
+        return createLiteral(tokens, toWord(-getRecursiveExpressionValue(inner)));
+    }
+    if(inner->type == negation) {
+        return inner->subNodes[0];
+    }
+    
+    tok->subNodes[0] = inner;
+    return tok;
+}
+
+static parseToken *simplifyBinary(parseToken *tok, arena *tokens) {
+    int wasLiteral = isLiteral(tok);
+    int operator = tok->values[0].value;
+    parseToken *left = simplifyExpression(tok->subNodes[0], tokens);
+    parseToken *right = simplifySecond(left, tok->subNodes[1], tokens,
+            operator == operatorAdd || operator == operatorSubtract);
+    
+    // The constant goes to the right, where it can be used directly as the operand
+    if(isLiteral(left) && !isLiteral(right)
+            && (operator == operatorAdd || operator == operatorMultiply)) {
+        parseToken *swap = left;
+        left = right;
+        right = swap;
+    }
+    tok->subNodes[0] = left;
+    tok->subNodes[1] = right;
+    tok->exprType = computedValue;
+    
+    if(!isLiteral(right)) {
+        if(operator == operatorSubtract && !hasCall(left) && sameExpression(left, right)) {
+            return createLiteral(tokens, 0);
+        }
+        return tok;
+    }
+    
+    int constant = toWord(getRecursiveExpressionValue(right));
+    
+    // Constants written as such are folded like before, the ones that only became constant here
+    // like the machine would compute them. A division by zero is left to the machine.
+    if(isLiteral(left) && !(constant == 0 && (operator == operatorDivide || operator == operatorModulo))) {
+        if(wasLiteral) {
+            return createLiteral(tokens, getRecursiveExpressionValue(tok));
+        }
+        int leftValue = toWord(getRecursiveExpressionValue(left));
+        return createLiteral(tokens, foldWords(operator, leftValue, constant));
+    }
+    
+    switch(operator) {
+        case operatorAdd:
+        case operatorSubtract:
+            if(constant == 0) {
+                return left;
+            }
+            return mergeAdditions(tok, tokens);
+        case operatorMultiply:
+            if(constant == 1) {
+                return left;
+            }
+            if(constant == 0 && !hasCall(left)) {
+                return createLiteral(tokens, 0);
+            }
+            return mergeMultiplications(tok, tokens);
+        case operatorDivide:
+            if(constant == 1) {
+                return left;
+            }
+            return tok;
+        case operatorModulo:
+            if((constant == 1 || constant == -1) && !hasCall(left)) {
+                return createLiteral(tokens, 0);
+            }
+            return tok;
+        default:
+            return tok;
+    }
+}
+
+// Returns the expression that replaces the token. The token itself is only changed so that it
+// still computes the same value.
+static parseToken *simplifyExpression(parseToken *tok, arena *tokens) {
+    if(tok->exprType == exprFailure || tok->exprType == array) {
+        return tok;
+    }
+    
+    switch(tok->type) {
+        case value:
+            simplifyTree(tok, tokens);
+            return tok;
+        case negation:
+            return simplifyNegation(tok, tokens);
+        default:
+            if(tok->nNodes == 1) {
+                return simplifyExpression(tok->subNodes[0], tokens);
+            }
+            return simplifyBinary(tok, tokens);
+    }
+}
+
+// An argument that wasn't a variable mustn't become one, the check for VAR parameters would
+// accept it otherwise
+static parseToken *simplifyArgument(parseToken *tok, arena *tokens) {
+    int variable = isVariable(tok);
+    parseToken *result = simplifyExpression(tok, tokens);
+    if(!variable && isVariable(result)) {
+        return tok;
+    }
+    return result;
+}
+
+// Folds the constant parts of every expression below the token and removes operations that don't
+// change the value, like x + 0, x * 1 or x - x. Has to run after annotateTree. The tree is rewritten
+// in place with new nodes from tokens, so it mustn't outlive them.
+void simplifyTree(parseToken *tok, arena *tokens) {
+    for(int i = 0; i < tok->nNodes; ++i) {
+        parseToken *node = tok->subNodes[i];
+        if(node == NULL) {
+            continue;
+        }
+        
+        if(!isExpression(node)) {
+            simplifyTree(node, tokens);
+        } else if(tok->type == paramListCall) {
+            tok->subNodes[i] = simplifyArgument(node, tokens);
+        } else if(tok->type == condition && i == 1) {
+            tok->subNodes[i] = simplifySecond(tok->subNodes[0], node, tokens, 0);
+        } else {
+            tok->subNodes[i] = simplifyExpression(node, tokens);
+        }
+    }
+}
@@ -0,0 +1,15 @@
+#ifndef SIMPLIFIER_H
+#define SIMPLIFIER_H
+
+#include "parsetree.h"
+#include "arena.h"
+
+int getRecursiveExpressionValue(parseToken *tok);
+
+int toWord(int value);
+
+int hasCall(parseToken *tok);
+
+void simplifyTree(parseToken *tok, arena *tokens);
+
+#endif //SIMPLIFIER_H
@@ -0,0 +1,98 @@
+#include "sourcebuffer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// The file is mapped over an anonymous mapping that is SOURCE_PADDING bytes longer, so the
+// padding is zero even if the file ends exactly at a page boundary. Files that can't be mapped,
+// like pipes, are read instead.
+int mapSourceFile(const char *path, sourceBuffer *source) {
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) {
+        return 1;
+    }
+    
+    struct stat info;
+    if(fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+        FILE *input = fdopen(fd, "r");
+        if(input == NULL) {
+            close(fd);
+            return 1;
+        }
+        int result = readSource(input, source);
+        fclose(input);
+        return result;
+    }
+    
+    size_t length = (size_t) info.st_size;
+    char *reserved = (char *) mmap(NULL, length + SOURCE_PADDING, PROT_READ,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(reserved == MAP_FAILED) {
+        close(fd);
+        return 1;
+    }
+    
+    // Read-only, the lexer only reads the text and the identifiers point into it
+    if(mmap(reserved, length, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(reserved, length + SOURCE_PADDING);
+        close(fd);
+        return 1;
+    }
+    close(fd);
+    
+    madvise(reserved, length, MADV_SEQUENTIAL);
+    
+    source->text = reserved;
+    source->length = length;
+    source->mappedLength = length + SOURCE_PADDING;
+    return 0;
+}
+
+int readSource(FILE *input, sourceBuffer *source) {
+    char *text = NULL;
+    size_t capacity = 0;
+    size_t length = 0;
+    
+    while(1) {
+        if(length + SOURCE_PADDING >= capacity) {
+            capacity = capacity * 2 + 4096;
+            char *tmp = (char *) realloc(text, capacity);
+            if(tmp == NULL) {
+                free(text);
+                return 1;
+            }
+            text = tmp;
+        }
+        
+        size_t count = fread(text + length, 1, capacity - length - SOURCE_PADDING, input);
+        if(count == 0) {
+            break;
+        }
+        length += count;
+    }
+    
+    if(ferror(input)) {
+        free(text);
+        return 1;
+    }
+    
+    memset(text + length, 0, SOURCE_PADDING);
+    source->text = text;
+    source->length = length;
+    source->mappedLength = 0;
+    return 0;
+}
+
+void freeSource(sourceBuffer *source) {
+    if(source->mappedLength > 0) {
+        munmap(source->text, source->mappedLength);
+    } else {
+        free(source->text);
+    }
+    source->text = NULL;
+    source->length = 0;
+    source->mappedLength = 0;
+}
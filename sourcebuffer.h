@@ -0,0 +1,26 @@
+#ifndef SOURCEBUFFER_H
+#define SOURCEBUFFER_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+// The scanner works on the text in place and needs two null bytes after it
+#define SOURCE_PADDING 2
+
+typedef struct sourceBuffer sourceBuffer;
+
+// The whole input in memory. Files are mapped, so the identifiers stay slices of the mapping
+// until they are interned. mappedLength is 0 if the text was allocated with malloc instead.
+struct sourceBuffer {
+    char *text;
+    size_t length;
+    size_t mappedLength;
+};
+
+int mapSourceFile(const char *path, sourceBuffer *source);
+
+int readSource(FILE *input, sourceBuffer *source);
+
+void freeSource(sourceBuffer *source);
+
+#endif //SOURCEBUFFER_H
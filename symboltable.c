@@ -0,0 +1,100 @@
+#include "symboltable.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_CAPACITY 16
+#define EMPTY_KEY (-1)
+
+unsigned int hashSymbol(int name) {
+    return (unsigned int) name * 2654435769u;
+}
+
+void initSymbolTable(symbolTable *table, int capacity) {
+    table->capacity = capacity;
+    table->nEntries = 0;
+    table->keys = (int *) malloc(capacity * sizeof(int));
+    table->values = (int *) malloc(capacity * sizeof(int));
+    memset(table->keys, EMPTY_KEY, capacity * sizeof(int));
+}
+
+symbolTable *createSymbolTable(void) {
+    symbolTable *result = (symbolTable *) malloc(sizeof(symbolTable));
+    initSymbolTable(result, INITIAL_CAPACITY);
+    return result;
+}
+
+symbolTable *cpSymbolTable(symbolTable *origin) {
+    symbolTable *result = (symbolTable *) malloc(sizeof(symbolTable));
+    initSymbolTable(result, origin->capacity);
+    result->nEntries = origin->nEntries;
+    memcpy(result->keys, origin->keys, origin->capacity * sizeof(int));
+    memcpy(result->values, origin->values, origin->capacity * sizeof(int));
+    return result;
+}
+
+void freeSymbolTable(symbolTable *table) {
+    free(table->keys);
+    free(table->values);
+    free(table);
+}
+
+int findSlot(symbolTable *table, int name) {
+    unsigned int mask = table->capacity - 1;
+    unsigned int slot = hashSymbol(name) & mask;
+    
+    while(table->keys[slot] != EMPTY_KEY && table->keys[slot] != name) {
+        slot = (slot + 1) & mask;
+    }
+    
+    return slot;
+}
+
+// Returns the value stored for the symbol id or -1, if it isn't in the table
+int lookupSymbol(symbolTable *table, int name) {
+    int slot = findSlot(table, name);
+    
+    if(table->keys[slot] == EMPTY_KEY) {
+        return -1;
+    }
+    
+    return table->values[slot];
+}
+
+void growSymbolTable(symbolTable *table) {
+    int *oldKeys = table->keys;
+    int *oldValues = table->values;
+    int oldCapacity = table->capacity;
+    
+    initSymbolTable(table, oldCapacity * 2);
+    
+    for(int i = 0; i < oldCapacity; ++i) {
+        if(oldKeys[i] != EMPTY_KEY) {
+            int slot = findSlot(table, oldKeys[i]);
+            table->keys[slot] = oldKeys[i];
+            table->values[slot] = oldValues[i];
+            ++(table->nEntries);
+        }
+    }
+    
+    free(oldKeys);
+    free(oldValues);
+}
+
+// Returns 0, if the symbol id is already in the table
+int insertSymbol(symbolTable *table, int name, int value) {
+    if(2 * (table->nEntries + 1) > table->capacity) {
+        growSymbolTable(table);
+    }
+    
+    int slot = findSlot(table, name);
+    
+    if(table->keys[slot] != EMPTY_KEY) {
+        return 0;
+    }
+    
+    table->keys[slot] = name;
+    table->values[slot] = value;
+    ++(table->nEntries);
+    
+    return 1;
+}
@@ -0,0 +1,23 @@
+#ifndef SYMBOLTABLE_H
+#define SYMBOLTABLE_H
+
+typedef struct symbolTable symbolTable;
+
+struct symbolTable {
+    int *keys;
+    int *values;
+    int capacity;
+    int nEntries;
+};
+
+symbolTable *createSymbolTable(void);
+
+symbolTable *cpSymbolTable(symbolTable *origin);
+
+void freeSymbolTable(symbolTable *table);
+
+int lookupSymbol(symbolTable *table, int name);
+
+int insertSymbol(symbolTable *table, int name, int value);
+
+#endif //SYMBOLTABLE_H
@@ -0,0 +1,33 @@
+#include "tempfile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Creates a new file next to the path, with the permissions a new file would get from the
+// umask. Unlike changing the umask to find them out, this is safe with several threads.
+int createTempFile(const char *path, char **tmpPath) {
+    static unsigned int counter = 0;
+    size_t length = strlen(path) + 48;
+    char *result = (char *) malloc(length);
+    
+    for(int attempt = 0; attempt < 100; ++attempt) {
+        unsigned int number = __atomic_fetch_add(&counter, 1, __ATOMIC_RELAXED);
+        snprintf(result, length, "%s.%ld.%u", path, (long) getpid(), number);
+        
+        int fd = open(result, O_WRONLY | O_CREAT | O_EXCL, 0666);
+        if(fd >= 0) {
+            *tmpPath = result;
+            return fd;
+        }
+        if(errno != EEXIST) {
+            break;
+        }
+    }
+    
+    free(result);
+    *tmpPath = NULL;
+    return -1;
+}
@@ -0,0 +1,6 @@
+#ifndef TEMPFILE_H
+#define TEMPFILE_H
+
+int createTempFile(const char *path, char **tmpPath);
+
+#endif //TEMPFILE_H
@@ -0,0 +1,229 @@
+#include "threadpool.h"
+#include <stdlib.h>
+#include <unistd.h>
+
+static __thread threadPool *currentPool = NULL;
+static __thread int currentQueue = -1;
+
+int defaultThreadCount(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    if(count < 1) {
+        return 1;
+    }
+    return (int) count;
+}
+
+// Workers use their own queue, every other thread shares the last one
+int ownQueue(threadPool *pool) {
+    if(currentPool == pool) {
+        return currentQueue;
+    }
+    return pool->nQueues - 1;
+}
+
+void pushBack(taskQueue *queue, poolTask *task) {
+    pthread_mutex_lock(&queue->lock);
+    task->next = NULL;
+    task->previous = queue->last;
+    if(queue->last == NULL) {
+        queue->first = task;
+    } else {
+        queue->last->next = task;
+    }
+    queue->last = task;
+    pthread_mutex_unlock(&queue->lock);
+}
+
+poolTask *popBack(taskQueue *queue) {
+    pthread_mutex_lock(&queue->lock);
+    poolTask *task = queue->last;
+    if(task != NULL) {
+        queue->last = task->previous;
+        if(queue->last == NULL) {
+            queue->first = NULL;
+        } else {
+            queue->last->next = NULL;
+        }
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return task;
+}
+
+poolTask *popFront(taskQueue *queue) {
+    pthread_mutex_lock(&queue->lock);
+    poolTask *task = queue->first;
+    if(task != NULL) {
+        queue->first = task->next;
+        if(queue->first == NULL) {
+            queue->last = NULL;
+        } else {
+            queue->first->previous = NULL;
+        }
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return task;
+}
+
+// Takes the newest task of the own queue, or steals the oldest one of another queue
+poolTask *findTask(threadPool *pool) {
+    int own = ownQueue(pool);
+    poolTask *task = NULL;
+    
+    if(own < pool->nQueues - 1) {
+        task = popBack(&pool->queues[own]);
+    }
+    
+    for(int i = 1; task == NULL && i <= pool->nQueues; ++i) {
+        task = popFront(&pool->queues[(own + i) % pool->nQueues]);
+    }
+    
+    if(task != NULL) {
+        pthread_mutex_lock(&pool->lock);
+        --(pool->queued);
+        pthread_mutex_unlock(&pool->lock);
+    }
+    
+    return task;
+}
+
+void runTask(threadPool *pool, poolTask *task) {
+    task->run(task->argument);
+    
+    pthread_mutex_lock(&pool->lock);
+    __atomic_store_n(&task->done, 1, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&pool->changed);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void *workerMain(void *argument) {
+    threadPool *pool = (threadPool *) argument;
+    
+    pthread_mutex_lock(&pool->lock);
+    currentPool = pool;
+    currentQueue = pool->nextQueue++;
+    pthread_mutex_unlock(&pool->lock);
+    
+    while(1) {
+        poolTask *task = findTask(pool);
+        if(task != NULL) {
+            runTask(pool, task);
+            continue;
+        }
+        
+        pthread_mutex_lock(&pool->lock);
+        while(!pool->stopping && pool->queued == 0) {
+            pthread_cond_wait(&pool->changed, &pool->lock);
+        }
+        int stopping = pool->stopping;
+        pthread_mutex_unlock(&pool->lock);
+        
+        if(stopping) {
+            break;
+        }
+    }
+    
+    return NULL;
+}
+
+// A pool with a single thread wouldn't run anything in parallel, so NULL is returned and
+// tasks submitted to it run directly
+threadPool *createThreadPool(int nThreads) {
+    if(nThreads < 2) {
+        return NULL;
+    }
+    
+    threadPool *pool = (threadPool *) malloc(sizeof(threadPool));
+    pool->threads = (pthread_t *) malloc(nThreads * sizeof(pthread_t));
+    pool->nThreads = 0;
+    pool->nQueues = nThreads + 1;
+    pool->queues = (taskQueue *) malloc(pool->nQueues * sizeof(taskQueue));
+    pool->nextQueue = 0;
+    pool->queued = 0;
+    pool->stopping = 0;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->changed, NULL);
+    
+    for(int i = 0; i < pool->nQueues; ++i) {
+        pthread_mutex_init(&pool->queues[i].lock, NULL);
+        pool->queues[i].first = NULL;
+        pool->queues[i].last = NULL;
+    }
+    
+    for(int i = 0; i < nThreads; ++i) {
+        if(pthread_create(&pool->threads[pool->nThreads], NULL, workerMain, pool) == 0) {
+            ++(pool->nThreads);
+        }
+    }
+    
+    if(pool->nThreads == 0) {
+        freeThreadPool(pool);
+        return NULL;
+    }
+    
+    return pool;
+}
+
+void freeThreadPool(threadPool *pool) {
+    if(pool == NULL) {
+        return;
+    }
+    
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->changed);
+    pthread_mutex_unlock(&pool->lock);
+    
+    for(int i = 0; i < pool->nThreads; ++i) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    
+    for(int i = 0; i < pool->nQueues; ++i) {
+        pthread_mutex_destroy(&pool->queues[i].lock);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->changed);
+    free(pool->queues);
+    free(pool->threads);
+    free(pool);
+}
+
+void submitTask(threadPool *pool, poolTask *task, void (*run)(void *), void *argument) {
+    task->run = run;
+    task->argument = argument;
+    task->done = 0;
+    
+    if(pool == NULL) {
+        run(argument);
+        task->done = 1;
+        return;
+    }
+    
+    pushBack(&pool->queues[ownQueue(pool)], task);
+    
+    pthread_mutex_lock(&pool->lock);
+    ++(pool->queued);
+    pthread_cond_broadcast(&pool->changed);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// The waiting thread runs queued tasks itself instead of blocking, so tasks can wait for
+// other tasks without starving the pool
+void waitForTask(threadPool *pool, poolTask *task) {
+    if(pool == NULL) {
+        return;
+    }
+    
+    while(!__atomic_load_n(&task->done, __ATOMIC_ACQUIRE)) {
+        poolTask *other = findTask(pool);
+        if(other != NULL) {
+            runTask(pool, other);
+            continue;
+        }
+        
+        pthread_mutex_lock(&pool->lock);
+        while(!task->done && pool->queued == 0) {
+            pthread_cond_wait(&pool->changed, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <pthread.h>
+
+typedef struct poolTask poolTask;
+
+struct poolTask {
+    void (*run)(void *);
+    void *argument;
+    int done;
+    poolTask *previous;
+    poolTask *next;
+};
+
+// The owner pushes and pops at the back, other workers steal from the front
+typedef struct taskQueue taskQueue;
+
+struct taskQueue {
+    pthread_mutex_t lock;
+    poolTask *first;
+    poolTask *last;
+};
+
+typedef struct threadPool threadPool;
+
+struct threadPool {
+    pthread_t *threads;
+    int nThreads;
+    // One queue per worker, the last one is for tasks submitted from other threads
+    taskQueue *queues;
+    int nQueues;
+    int nextQueue;
+    int queued;
+    int stopping;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+};
+
+int defaultThreadCount(void);
+
+threadPool *createThreadPool(int nThreads);
+
+void freeThreadPool(threadPool *pool);
+
+void submitTask(threadPool *pool, poolTask *task, void (*run)(void *), void *argument);
+
+void waitForTask(threadPool *pool, poolTask *task);
+
+#endif //THREADPOOL_H